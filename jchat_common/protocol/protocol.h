@@ -1,28 +1,32 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#ifndef jchat_common_protocol_h_
-#define jchat_common_protocol_h_
-
-#ifndef JCHAT_CHAT_PROTOCOL_VERSION
-#define JCHAT_CHAT_PROTOCOL_VERSION "1.2.6"
-#endif // JCHAT_CHAT_PROTOCOL_VERSION
-
-#ifndef JCHAT_CHAT_USERNAME_LENGTH
-#define JCHAT_CHAT_USERNAME_LENGTH 24
-#endif // JCHAT_CHAT_USERNAME_LENGTH
-
-#ifndef JCHAT_CHAT_CHANNEL_NAME_LENGTH
-#define JCHAT_CHAT_CHANNEL_NAME_LENGTH 24
-#endif // JCHAT_CHAT_CHANNEL_NAME_LENGTH
-
-#ifndef JCHAT_CHAT_MESSAGE_LENGTH
-#define JCHAT_CHAT_MESSAGE_LENGTH 1024
-#endif // JCHAT_CHAT_MESSAGE_LENGTH
-
-#endif // jchat_common_protocol_h_
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_common_protocol_h_
+#define jchat_common_protocol_h_
+
+#ifndef JCHAT_CHAT_PROTOCOL_VERSION
+#define JCHAT_CHAT_PROTOCOL_VERSION "1.2.6"
+#endif // JCHAT_CHAT_PROTOCOL_VERSION
+
+#ifndef JCHAT_CHAT_USERNAME_LENGTH
+#define JCHAT_CHAT_USERNAME_LENGTH 24
+#endif // JCHAT_CHAT_USERNAME_LENGTH
+
+#ifndef JCHAT_CHAT_CHANNEL_NAME_LENGTH
+#define JCHAT_CHAT_CHANNEL_NAME_LENGTH 24
+#endif // JCHAT_CHAT_CHANNEL_NAME_LENGTH
+
+#ifndef JCHAT_CHAT_MESSAGE_LENGTH
+#define JCHAT_CHAT_MESSAGE_LENGTH 1024
+#endif // JCHAT_CHAT_MESSAGE_LENGTH
+
+#ifndef JCHAT_CHAT_FRAME_SIZE_LIMIT
+#define JCHAT_CHAT_FRAME_SIZE_LIMIT 16777216
+#endif // JCHAT_CHAT_FRAME_SIZE_LIMIT
+
+#endif // jchat_common_protocol_h_
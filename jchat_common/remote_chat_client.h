@@ -1,23 +1,68 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#ifndef jchat_common_remote_chat_client_h_
-#define jchat_common_remote_chat_client_h_
-
-#include "ip_endpoint.hpp"
-#include <string>
-#include <vector>
-#include <mutex>
-
-namespace jchat {
-struct RemoteChatClient {
-  IPEndpoint Endpoint;
-};
-}
-
-#endif // jchat_common_remote_chat_client_h_
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_common_remote_chat_client_h_
+#define jchat_common_remote_chat_client_h_
+
+#include "ip_endpoint.hpp"
+#include "slot_map.hpp"
+#include "token_bucket.hpp"
+#include "protocol/component_type.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
+
+namespace jchat {
+struct RemoteChatClient {
+  IPEndpoint Endpoint;
+
+  // The handle of the connection, it's the same as the one the TcpServer has
+  // for the client and goes stale once the client disconnects
+  SlotHandle Handle;
+
+  // The client's share of the server's rate limit, see RateLimiter. NOTE:
+  // Only used by the thread handling the client
+  TrafficBucket Traffic;
+
+  // State kept by each component for the client, indexed by the component's
+  // type. There's a slot for every component the server has, each component
+  // fills its own slot when the client connects
+  std::vector<std::shared_ptr<void>> States;
+
+  template<typename _TState>
+  _TState *GetState(ComponentType component_type) {
+    if (component_type >= States.size()) {
+      return nullptr;
+    }
+    return static_cast<_TState *>(States[component_type].get());
+  }
+
+  template<typename _TState>
+  bool GetState(ComponentType component_type,
+    std::shared_ptr<_TState> &out_state) {
+    if (component_type >= States.size() || !States[component_type]) {
+      return false;
+    }
+    out_state = std::static_pointer_cast<_TState>(States[component_type]);
+    return true;
+  }
+
+  template<typename _TState>
+  bool SetState(ComponentType component_type,
+    const std::shared_ptr<_TState> &state) {
+    if (component_type >= States.size()) {
+      return false;
+    }
+    States[component_type] = state;
+    return true;
+  }
+};
+}
+
+#endif // jchat_common_remote_chat_client_h_
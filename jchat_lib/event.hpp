@@ -1,71 +1,91 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#ifndef jchat_lib_event_hpp_
-#define jchat_lib_event_hpp_
-
-// Required libraries
-#include <mutex>
-#include <vector>
-#include <functional>
-
-namespace jchat {
-template<typename... _TArgs>
-struct EventCallback {
-  std::function<bool(_TArgs...)> Function;
-  bool IsTemporary;
-};
-
-template<typename... _TArgs>
-class Event {
-  std::mutex event_mutex_;
-  std::vector<EventCallback<_TArgs...>> callbacks_;
-
-public:
-  Event() {}
-  Event(const Event &event) {}
-
-  template<typename _TFunction>
-  Event &Add(_TFunction function, bool is_temporary = false) {
-    event_mutex_.lock();
-
-    EventCallback<_TArgs...> callback;
-    callback.Function = function;
-    callback.IsTemporary = is_temporary;
-    callbacks_.push_back(callback);
-
-    event_mutex_.unlock();
-
-    return *this;
-  }
-
-  bool operator()(_TArgs... arguments) {
-    event_mutex_.lock();
-
-    bool success = true;
-
-    for (auto iterator = callbacks_.begin(); iterator != callbacks_.end();) {
-      if (!iterator->Function(arguments...)) {
-        success = false;
-      }
-
-      if (iterator->IsTemporary) {
-        iterator = callbacks_.erase(iterator);
-      } else {
-        ++iterator;
-      }
-    }
-
-    event_mutex_.unlock();
-
-    return success;
-  }
-};
-}
-
-#endif // jchat_lib_event_hpp_
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_event_hpp_
+#define jchat_lib_event_hpp_
+
+// Required libraries
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <functional>
+
+namespace jchat {
+template<typename... _TArgs>
+struct EventCallback {
+  std::function<bool(_TArgs...)> Function;
+  bool IsTemporary;
+};
+
+template<typename... _TArgs>
+class Event {
+  typedef std::vector<EventCallback<_TArgs...>> CallbackList;
+
+  // The callback list is copied on write, so invoking the event only needs to
+  // take a reference to the current list rather than holding the lock while
+  // the callbacks run, which lets multiple threads invoke the event at once
+  std::mutex event_mutex_;
+  std::shared_ptr<CallbackList> callbacks_;
+
+public:
+  Event() : callbacks_(std::make_shared<CallbackList>()) {}
+  Event(const Event &event) : callbacks_(std::make_shared<CallbackList>()) {}
+
+  template<typename _TFunction>
+  Event &Add(_TFunction function, bool is_temporary = false) {
+    event_mutex_.lock();
+
+    EventCallback<_TArgs...> callback;
+    callback.Function = function;
+    callback.IsTemporary = is_temporary;
+
+    auto callbacks = std::make_shared<CallbackList>(*callbacks_);
+    callbacks->push_back(callback);
+    callbacks_ = callbacks;
+
+    event_mutex_.unlock();
+
+    return *this;
+  }
+
+  bool operator()(_TArgs... arguments) {
+    event_mutex_.lock();
+
+    std::shared_ptr<CallbackList> callbacks = callbacks_;
+
+    // Remove temporary callbacks before calling them so that they're only
+    // ever called once
+    for (auto &callback : *callbacks) {
+      if (callback.IsTemporary) {
+        auto remaining_callbacks = std::make_shared<CallbackList>();
+        for (auto &remaining_callback : *callbacks) {
+          if (!remaining_callback.IsTemporary) {
+            remaining_callbacks->push_back(remaining_callback);
+          }
+        }
+        callbacks_ = remaining_callbacks;
+        break;
+      }
+    }
+
+    event_mutex_.unlock();
+
+    bool success = true;
+
+    for (auto &callback : *callbacks) {
+      if (!callback.Function(arguments...)) {
+        success = false;
+      }
+    }
+
+    return success;
+  }
+};
+}
+
+#endif // jchat_lib_event_hpp_
@@ -0,0 +1,350 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_executor_hpp_
+#define jchat_lib_executor_hpp_
+
+// Required libraries
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+#include <stdint.h>
+
+// The number of tasks a strand runs before it gives the worker up to others
+#ifndef JCHAT_STRAND_BATCH_SIZE
+#define JCHAT_STRAND_BATCH_SIZE 32
+#endif // JCHAT_STRAND_BATCH_SIZE
+
+namespace jchat {
+// Runs tasks on a pool of worker threads. Every worker has its own queue,
+// tasks posted from a worker go to its own queue and tasks posted from any
+// other thread are spread over the queues. A worker which runs out of tasks
+// steals from the other workers' queues
+// Example:
+//    Executor executor;
+//    executor.Start(4);
+//    executor.Post([]() { printf("Hello from a worker\n"); });
+//    executor.Stop(); // Runs what's left before returning
+class Executor {
+  struct Worker {
+    size_t Index;
+    std::deque<std::function<void()>> Tasks;
+    std::mutex TasksMutex;
+    std::thread Thread;
+  };
+
+  std::vector<Worker *> workers_;
+  std::atomic<size_t> next_worker_;
+
+  // The number of tasks posted but not yet taken by a worker, sleeping
+  // workers are woken up through the condition when it goes above 0
+  std::atomic<int64_t> pending_count_;
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+
+  // Posting is refused once is_running_ is cleared, and Stop waits for the
+  // posts already past the check (posting_count_) before it tells the
+  // workers to leave with is_stopping_, which is guarded by sleep_mutex_
+  std::atomic<bool> is_running_;
+  std::atomic<uint32_t> posting_count_;
+  bool is_stopping_;
+
+  // The executor and worker the calling thread belongs to, if it's a worker
+  static Executor *&currentExecutor() {
+    static thread_local Executor *executor = nullptr;
+    return executor;
+  }
+
+  static Worker *&currentWorker() {
+    static thread_local Worker *worker = nullptr;
+    return worker;
+  }
+
+  // Tasks a thread handed back to its own loop, see Defer
+  struct DeferredTasks {
+    bool IsEnabled;
+    std::deque<std::function<void()>> Tasks;
+
+    DeferredTasks() : IsEnabled(false) {
+    }
+  };
+
+  static DeferredTasks &deferredTasks() {
+    static thread_local DeferredTasks tasks;
+    return tasks;
+  }
+
+  bool popTask(Worker &worker, std::function<void()> &out_task) {
+    // Take the oldest task from our own queue first, so that a task which
+    // queues itself again goes behind the others
+    worker.TasksMutex.lock();
+    if (!worker.Tasks.empty()) {
+      out_task = std::move(worker.Tasks.front());
+      worker.Tasks.pop_front();
+      worker.TasksMutex.unlock();
+      return true;
+    }
+    worker.TasksMutex.unlock();
+
+    // Steal the newest task from one of the other workers, the end its owner
+    // isn't working on
+    for (size_t i = 1; i < workers_.size(); i++) {
+      Worker &victim = *workers_[(worker.Index + i) % workers_.size()];
+      std::unique_lock<std::mutex> victim_lock(victim.TasksMutex,
+        std::try_to_lock);
+      if (!victim_lock.owns_lock() || victim.Tasks.empty()) {
+        continue;
+      }
+      out_task = std::move(victim.Tasks.back());
+      victim.Tasks.pop_back();
+      return true;
+    }
+
+    return false;
+  }
+
+  void worker_loop(Worker *worker) {
+    currentExecutor() = this;
+    currentWorker() = worker;
+
+    std::function<void()> task;
+    while (true) {
+      if (pending_count_ > 0 && popTask(*worker, task)) {
+        pending_count_--;
+        task();
+        task = nullptr;
+        continue;
+      }
+
+      // Sleep until there's something to do, once stopped the worker only
+      // leaves when every task has been run
+      std::unique_lock<std::mutex> sleep_lock(sleep_mutex_);
+      if (is_stopping_ && pending_count_ <= 0) {
+        break;
+      }
+      sleep_condition_.wait(sleep_lock, [this]() {
+        return pending_count_ > 0 || is_stopping_;
+      });
+    }
+
+    currentExecutor() = nullptr;
+    currentWorker() = nullptr;
+  }
+
+public:
+  Executor() : next_worker_(0), pending_count_(0), is_running_(false),
+    posting_count_(0), is_stopping_(false) {
+  }
+
+  ~Executor() {
+    Stop();
+  }
+
+  bool Start(uint32_t worker_count) {
+    if (is_running_ || worker_count == 0) {
+      return false;
+    }
+
+    is_stopping_ = false;
+    for (uint32_t i = 0; i < worker_count; i++) {
+      Worker *worker = new Worker();
+      worker->Index = i;
+      workers_.push_back(worker);
+    }
+    for (auto worker : workers_) {
+      worker->Thread = std::thread(&Executor::worker_loop, this, worker);
+    }
+    is_running_ = true;
+
+    return true;
+  }
+
+  // Stops the workers after they have run every task which was posted
+  bool Stop() {
+    bool is_running = true;
+    if (!is_running_.compare_exchange_strong(is_running, false)) {
+      return false;
+    }
+
+    // Let the posts which got in before us finish queueing
+    while (posting_count_ > 0) {
+      std::this_thread::yield();
+    }
+
+    sleep_mutex_.lock();
+    is_stopping_ = true;
+    sleep_mutex_.unlock();
+    sleep_condition_.notify_all();
+
+    for (auto worker : workers_) {
+      worker->Thread.join();
+    }
+    for (auto worker : workers_) {
+      delete worker;
+    }
+    workers_.clear();
+
+    return true;
+  }
+
+  // Queues a task to be run by one of the workers, this is safe to call from
+  // any thread including the workers. Returns false if the executor isn't
+  // running, the task is dropped then
+  bool Post(std::function<void()> task) {
+    posting_count_++;
+    if (!is_running_) {
+      posting_count_--;
+      return false;
+    }
+
+    Worker *worker = nullptr;
+    if (currentExecutor() == this) {
+      worker = currentWorker();
+    } else {
+      worker = workers_[next_worker_++ % workers_.size()];
+    }
+
+    // Count the task before it's queued so that a worker which finds it never
+    // takes the count below 0
+    pending_count_++;
+    worker->TasksMutex.lock();
+    worker->Tasks.push_back(std::move(task));
+    worker->TasksMutex.unlock();
+    posting_count_--;
+
+    // Taking the lock makes sure a worker which is about to sleep sees the
+    // task before it waits
+    sleep_mutex_.lock();
+    sleep_mutex_.unlock();
+    sleep_condition_.notify_one();
+
+    return true;
+  }
+
+  bool IsRunning() {
+    return is_running_;
+  }
+
+  size_t GetWorkerCount() {
+    return workers_.size();
+  }
+
+  // Marks the calling thread as one with a loop which calls RunDeferred on
+  // every pass, so that work can be handed back to it with Defer
+  static void EnableDeferred() {
+    deferredTasks().IsEnabled = true;
+  }
+
+  // Queues a task for the calling thread's next RunDeferred. Returns false if
+  // the thread has no loop which runs them
+  static bool Defer(std::function<void()> task) {
+    DeferredTasks &deferred = deferredTasks();
+    if (!deferred.IsEnabled) {
+      return false;
+    }
+    deferred.Tasks.push_back(std::move(task));
+    return true;
+  }
+
+  static bool HasDeferred() {
+    return !deferredTasks().Tasks.empty();
+  }
+
+  // Runs the tasks deferred so far, tasks they defer wait for the next call
+  static void RunDeferred() {
+    std::deque<std::function<void()>> tasks;
+    tasks.swap(deferredTasks().Tasks);
+    for (auto &task : tasks) {
+      task();
+    }
+  }
+};
+
+// Runs tasks one at a time in the order they were posted, on whichever
+// worker of an executor is free. Strands are used to keep the tasks for one
+// thing in order while the tasks for different things run in parallel. If the
+// executor isn't running, the thread which posts to an idle strand runs a
+// batch of its tasks and defers the rest to its own loop (see
+// Executor::Defer), or runs them all if it has no loop. Either way the tasks
+// never overlap
+class Strand : public std::enable_shared_from_this<Strand> {
+  Executor &executor_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex tasks_mutex_;
+  bool is_scheduled_;
+
+  void run() {
+    while (true) {
+      for (size_t i = 0; i < JCHAT_STRAND_BATCH_SIZE; i++) {
+        tasks_mutex_.lock();
+        if (tasks_.empty()) {
+          is_scheduled_ = false;
+          tasks_mutex_.unlock();
+          return;
+        }
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        tasks_mutex_.unlock();
+
+        task();
+      }
+
+      // Go to the back of the line so that one busy strand can't hold a
+      // worker, or the loop of the thread running it. The strand stays
+      // scheduled until it runs again
+      auto strand = shared_from_this();
+      std::function<void()> next_run = [strand]() {
+        strand->run();
+      };
+      if ((executor_.IsRunning() && executor_.Post(next_run))
+        || Executor::Defer(next_run)) {
+        return;
+      }
+
+      // There's nowhere to hand it to, so carry on here
+    }
+  }
+
+public:
+  Strand(Executor &executor) : executor_(executor), is_scheduled_(false) {
+  }
+
+  // Queues a task after the ones already posted to the strand, this is safe
+  // to call from any thread. NOTE: The strand must be owned by a shared_ptr
+  bool Post(std::function<void()> task) {
+    tasks_mutex_.lock();
+    tasks_.push_back(std::move(task));
+    if (is_scheduled_) {
+      tasks_mutex_.unlock();
+      return true;
+    }
+    is_scheduled_ = true;
+    tasks_mutex_.unlock();
+
+    // Run the tasks here if the executor isn't running, or stopped before
+    // it took them
+    if (executor_.IsRunning()) {
+      auto strand = shared_from_this();
+      if (executor_.Post([strand]() {
+        strand->run();
+      })) {
+        return true;
+      }
+    }
+    run();
+    return true;
+  }
+};
+}
+
+#endif // jchat_lib_executor_hpp_
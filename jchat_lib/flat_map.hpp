@@ -0,0 +1,108 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_flat_map_hpp_
+#define jchat_lib_flat_map_hpp_
+
+// Required libraries
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace jchat {
+// A map kept as a sorted vector of pairs. Lookups are a binary search and
+// walking it is a walk over contiguous memory, inserting and removing move
+// the pairs behind the key, so it suits small maps which are read far more
+// than they change. NOTE: This isn't thread safe
+// Example:
+//    FlatMap<int, std::string> names;
+//    names.Set(5, "John");
+//    std::string *name = names.Find(5); // "John"
+//    for (auto &pair : names) { ... }
+template<typename _TKey, typename _TValue>
+class FlatMap {
+public:
+  typedef std::pair<_TKey, _TValue> Pair;
+  typedef typename std::vector<Pair>::iterator Iterator;
+  typedef typename std::vector<Pair>::const_iterator ConstIterator;
+
+private:
+  std::vector<Pair> pairs_;
+
+  Iterator lowerBound(const _TKey &key) {
+    return std::lower_bound(pairs_.begin(), pairs_.end(), key,
+      [](const Pair &pair, const _TKey &key) {
+      return pair.first < key;
+    });
+  }
+
+public:
+  // Adds the value or replaces the one the key already has
+  void Set(const _TKey &key, const _TValue &value) {
+    Iterator it = lowerBound(key);
+    if (it != pairs_.end() && !(key < it->first)) {
+      it->second = value;
+      return;
+    }
+    pairs_.insert(it, Pair(key, value));
+  }
+
+  bool Remove(const _TKey &key) {
+    Iterator it = lowerBound(key);
+    if (it == pairs_.end() || key < it->first) {
+      return false;
+    }
+    pairs_.erase(it);
+    return true;
+  }
+
+  // Returns the key's value, or nullptr if it isn't in the map
+  _TValue *Find(const _TKey &key) {
+    Iterator it = lowerBound(key);
+    if (it == pairs_.end() || key < it->first) {
+      return nullptr;
+    }
+    return &it->second;
+  }
+
+  bool Contains(const _TKey &key) {
+    return Find(key) != nullptr;
+  }
+
+  void Clear() {
+    pairs_.clear();
+  }
+
+  bool IsEmpty() const {
+    return pairs_.empty();
+  }
+
+  size_t GetSize() const {
+    return pairs_.size();
+  }
+
+  // Pairs are in key order
+  Iterator begin() {
+    return pairs_.begin();
+  }
+
+  Iterator end() {
+    return pairs_.end();
+  }
+
+  ConstIterator begin() const {
+    return pairs_.begin();
+  }
+
+  ConstIterator end() const {
+    return pairs_.end();
+  }
+};
+}
+
+#endif // jchat_lib_flat_map_hpp_
@@ -0,0 +1,323 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_io_uring_hpp_
+#define jchat_lib_io_uring_hpp_
+
+// Required libraries
+#include "platform.h"
+#if defined(OS_LINUX)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+// The features we rely on (multishot accept/receive and provided buffer
+// rings) need to be known to the kernel headers we're built against
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_ACCEPT_MULTISHOT) \
+  && defined(IORING_SETUP_DEFER_TASKRUN)
+#define JCHAT_IO_URING
+#endif
+#endif
+
+#if defined(JCHAT_IO_URING)
+namespace jchat {
+// A minimal io_uring instance used through the raw system calls. The ring is
+// meant to be owned and driven by a single thread
+// Example:
+//    IoUring ring;
+//    if (ring.Initialize(256) && ring.Enable()) {
+//      io_uring_sqe *sqe = ring.GetSqe();
+//      sqe->opcode = IORING_OP_NOP;
+//      ring.Submit(1);
+//      io_uring_cqe *cqe;
+//      while ((cqe = ring.PeekCqe()) != nullptr) {
+//        ...
+//        ring.SeenCqe();
+//      }
+//    }
+class IoUring {
+  int ring_fd_;
+  void *sq_ring_;
+  size_t sq_ring_size_;
+  void *cq_ring_;
+  size_t cq_ring_size_;
+  io_uring_sqe *sqes_;
+  size_t sqes_size_;
+
+  // Submission queue
+  uint32_t *sq_head_;
+  uint32_t *sq_tail_;
+  uint32_t *sq_array_;
+  uint32_t sq_mask_;
+  uint32_t sq_entries_;
+  uint32_t sq_local_tail_;
+  uint32_t to_submit_;
+
+  // Completion queue
+  uint32_t *cq_head_;
+  uint32_t *cq_tail_;
+  uint32_t cq_mask_;
+  io_uring_cqe *cqes_;
+
+  // Provided buffers, the kernel picks one of these for every receive
+  // completion and we hand it back once the data has been consumed
+  io_uring_buf_ring *buffer_ring_;
+  size_t buffer_ring_size_;
+  uint16_t buffer_group_;
+  uint16_t buffer_count_;
+  uint32_t buffer_size_;
+  std::vector<uint8_t> buffers_;
+
+  void addBuffer(uint16_t buffer_id, uint16_t offset) {
+    // NOTE: The entries are indexed from the start of the ring rather than
+    // through bufs, which C++ compilers place after the empty struct that the
+    // kernel headers use to declare it
+    uint16_t tail = buffer_ring_->tail;
+    io_uring_buf &buffer = ((io_uring_buf *)buffer_ring_)[(tail + offset)
+      & (buffer_count_ - 1)];
+    buffer.addr = (uint64_t)(buffers_.data()
+      + (size_t)buffer_id * buffer_size_);
+    buffer.len = buffer_size_;
+    buffer.bid = buffer_id;
+  }
+
+  void destroy() {
+    if (ring_fd_ != -1) {
+      close(ring_fd_);
+      ring_fd_ = -1;
+    }
+    if (buffer_ring_ != nullptr) {
+      munmap(buffer_ring_, buffer_ring_size_);
+      buffer_ring_ = nullptr;
+    }
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+      sqes_ = nullptr;
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    cq_ring_ = nullptr;
+    if (sq_ring_ != nullptr) {
+      munmap(sq_ring_, sq_ring_size_);
+      sq_ring_ = nullptr;
+    }
+  }
+
+public:
+  IoUring() : ring_fd_(-1), sq_ring_(nullptr), sq_ring_size_(0),
+    cq_ring_(nullptr), cq_ring_size_(0), sqes_(nullptr), sqes_size_(0),
+    sq_local_tail_(0), to_submit_(0), buffer_ring_(nullptr),
+    buffer_ring_size_(0), buffer_group_(0), buffer_count_(0),
+    buffer_size_(0) {
+  }
+
+  ~IoUring() {
+    destroy();
+  }
+
+  // Creates the ring, fails on kernels which are too old for the features we
+  // use (or where io_uring is disabled) so that the caller can fall back
+  bool Initialize(uint32_t entries) {
+    if (ring_fd_ != -1) {
+      return false;
+    }
+
+    // Only one thread submits to the ring, which lets the kernel defer
+    // completion work until we ask for events. The ring starts disabled so
+    // that it can be set up here and handed to the thread which enables it
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN
+      | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_R_DISABLED;
+    ring_fd_ = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring_fd_ == -1) {
+      return false;
+    }
+    if (!(params.features & IORING_FEAT_NODROP)) {
+      destroy();
+      return false;
+    }
+
+    // Map the rings
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_ring_size_ = params.cq_off.cqes
+      + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+      sq_ring_ = nullptr;
+      destroy();
+      return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      cq_ring_ = sq_ring_;
+    } else {
+      cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+      if (cq_ring_ == MAP_FAILED) {
+        cq_ring_ = nullptr;
+        destroy();
+        return false;
+      }
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+      destroy();
+      return false;
+    }
+    sqes_ = (io_uring_sqe *)sqes;
+
+    uint8_t *sq_ring = (uint8_t *)sq_ring_;
+    sq_head_ = (uint32_t *)(sq_ring + params.sq_off.head);
+    sq_tail_ = (uint32_t *)(sq_ring + params.sq_off.tail);
+    sq_array_ = (uint32_t *)(sq_ring + params.sq_off.array);
+    sq_mask_ = *(uint32_t *)(sq_ring + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_local_tail_ = *sq_tail_;
+
+    uint8_t *cq_ring = (uint8_t *)cq_ring_;
+    cq_head_ = (uint32_t *)(cq_ring + params.cq_off.head);
+    cq_tail_ = (uint32_t *)(cq_ring + params.cq_off.tail);
+    cq_mask_ = *(uint32_t *)(cq_ring + params.cq_off.ring_mask);
+    cqes_ = (io_uring_cqe *)(cq_ring + params.cq_off.cqes);
+
+    return true;
+  }
+
+  // Enables the ring, the calling thread becomes the only one allowed to
+  // submit to it
+  bool Enable() {
+    return syscall(__NR_io_uring_register, ring_fd_,
+      IORING_REGISTER_ENABLE_RINGS, nullptr, 0) != -1;
+  }
+
+  // Registers buffer_count buffers of buffer_size bytes with the kernel for
+  // receive operations using IOSQE_BUFFER_SELECT. NOTE: buffer_count must be a
+  // power of two
+  bool RegisterBuffers(uint16_t buffer_group, uint16_t buffer_count,
+    uint32_t buffer_size) {
+    if (ring_fd_ == -1 || buffer_ring_ != nullptr || buffer_count == 0
+      || (buffer_count & (buffer_count - 1)) != 0) {
+      return false;
+    }
+
+    buffer_ring_size_ = buffer_count * sizeof(io_uring_buf);
+    void *buffer_ring = mmap(nullptr, buffer_ring_size_,
+      PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer_ring == MAP_FAILED) {
+      return false;
+    }
+    buffer_ring_ = (io_uring_buf_ring *)buffer_ring;
+
+    io_uring_buf_reg buffer_registration;
+    memset(&buffer_registration, 0, sizeof(buffer_registration));
+    buffer_registration.ring_addr = (uint64_t)buffer_ring_;
+    buffer_registration.ring_entries = buffer_count;
+    buffer_registration.bgid = buffer_group;
+    if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING,
+      &buffer_registration, 1) == -1) {
+      munmap(buffer_ring_, buffer_ring_size_);
+      buffer_ring_ = nullptr;
+      return false;
+    }
+
+    buffer_group_ = buffer_group;
+    buffer_count_ = buffer_count;
+    buffer_size_ = buffer_size;
+    buffers_.resize((size_t)buffer_count * buffer_size);
+    for (uint16_t i = 0; i < buffer_count; i++) {
+      addBuffer(i, i);
+    }
+    __atomic_store_n(&buffer_ring_->tail,
+      (uint16_t)(buffer_ring_->tail + buffer_count), __ATOMIC_RELEASE);
+
+    return true;
+  }
+
+  const uint8_t *GetBuffer(uint16_t buffer_id) {
+    return buffers_.data() + (size_t)buffer_id * buffer_size_;
+  }
+
+  // Hands a provided buffer back to the kernel once its data was consumed
+  void RecycleBuffer(uint16_t buffer_id) {
+    addBuffer(buffer_id, 0);
+    __atomic_store_n(&buffer_ring_->tail, (uint16_t)(buffer_ring_->tail + 1),
+      __ATOMIC_RELEASE);
+  }
+
+  uint16_t GetBufferGroup() {
+    return buffer_group_;
+  }
+
+  // Returns a cleared submission entry, submitting what's queued first if the
+  // queue is full. Returns nullptr if no entry could be made available
+  io_uring_sqe *GetSqe() {
+    uint32_t head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_local_tail_ - head >= sq_entries_) {
+      if (Submit(0) == -1) {
+        return nullptr;
+      }
+      head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+      if (sq_local_tail_ - head >= sq_entries_) {
+        return nullptr;
+      }
+    }
+
+    uint32_t index = sq_local_tail_ & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    sq_local_tail_++;
+    to_submit_++;
+    return sqe;
+  }
+
+  // Submits everything queued with a single system call, and waits until at
+  // least wait_count completions are available. Returns -1 on failure
+  int32_t Submit(uint32_t wait_count) {
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    // The kernel only posts completions when asked for events since the ring
+    // defers its task work, so ask even when not waiting
+    int32_t submitted = syscall(__NR_io_uring_enter, ring_fd_, to_submit_,
+      wait_count, IORING_ENTER_GETEVENTS, nullptr, 0);
+    if (submitted > 0) {
+      to_submit_ -= std::min((uint32_t)submitted, to_submit_);
+    }
+    return submitted;
+  }
+
+  // Returns the next completion, or nullptr if there are none available. The
+  // completion must be released using SeenCqe once it has been handled
+  io_uring_cqe *PeekCqe() {
+    uint32_t head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      return nullptr;
+    }
+    return &cqes_[head & cq_mask_];
+  }
+
+  void SeenCqe() {
+    __atomic_store_n(cq_head_, *cq_head_ + 1, __ATOMIC_RELEASE);
+  }
+};
+}
+#endif // JCHAT_IO_URING
+
+#endif // jchat_lib_io_uring_hpp_
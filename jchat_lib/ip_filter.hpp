@@ -0,0 +1,284 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_ip_filter_hpp_
+#define jchat_lib_ip_filter_hpp_
+
+// Required libraries
+#include "rcu.hpp"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <stdint.h>
+
+namespace jchat {
+// IPv4 prefixes in a binary trie where chains of single children are
+// collapsed into one node, so a lookup visits at most one node per prefix
+// length that's actually in it. NOTE: This isn't thread safe, share it
+// through IpFilter
+class IpPrefixTrie {
+  struct Node {
+    uint32_t Prefix;
+    uint8_t Length;
+    bool IsListed; // False for nodes which only join two branches
+    int32_t Children[2];
+  };
+
+  std::vector<Node> nodes_;
+  int32_t root_;
+  size_t size_;
+
+  static uint32_t getMask(uint8_t length) {
+    return length == 0 ? 0 : 0xFFFFFFFFu << (32 - length);
+  }
+
+  // The bit after the first position bits, 0 or 1
+  static uint32_t getBit(uint32_t address, uint8_t position) {
+    return (address >> (31 - position)) & 1;
+  }
+
+  int32_t addNode(uint32_t prefix, uint8_t length, bool is_listed) {
+    Node node = { prefix, length, is_listed, { -1, -1 } };
+    nodes_.push_back(node);
+    return static_cast<int32_t>(nodes_.size() - 1);
+  }
+
+  // Reads the decimal digits at position and moves past them, returns false
+  // if there are none or the number is above the limit
+  static bool readNumber(const char *&position, uint32_t limit,
+    uint32_t &out_number) {
+    if (*position < '0' || *position > '9') {
+      return false;
+    }
+    uint32_t number = 0;
+    while (*position >= '0' && *position <= '9') {
+      number = number * 10 + (*position++ - '0');
+      if (number > limit) {
+        return false;
+      }
+    }
+    out_number = number;
+    return true;
+  }
+
+  void setChild(int32_t parent, uint32_t side, int32_t child) {
+    if (parent == -1) {
+      root_ = child;
+    } else {
+      nodes_[parent].Children[side] = child;
+    }
+  }
+
+public:
+  IpPrefixTrie() : root_(-1), size_(0) {
+  }
+
+  // Adds address/length, addresses are in host byte order
+  void Add(uint32_t address, uint8_t length) {
+    uint32_t prefix = address & getMask(length);
+    int32_t parent = -1;
+    uint32_t side = 0;
+    int32_t current = root_;
+    while (current != -1) {
+      Node node = nodes_[current];
+      uint8_t common = 0;
+      uint8_t common_limit = std::min(node.Length, length);
+      while (common < common_limit
+        && getBit(node.Prefix, common) == getBit(prefix, common)) {
+        common++;
+      }
+
+      if (common == node.Length) {
+        if (length == node.Length) {
+          if (!node.IsListed) {
+            nodes_[current].IsListed = true;
+            size_++;
+          }
+          return;
+        }
+
+        // The node covers the prefix, carry on below it
+        parent = current;
+        side = getBit(prefix, node.Length);
+        current = node.Children[side];
+        continue;
+      }
+
+      // The prefix branches off inside the node, so split it where they part
+      int32_t split = addNode(prefix & getMask(common), common,
+        common == length);
+      nodes_[split].Children[getBit(node.Prefix, common)] = current;
+      if (common != length) {
+        int32_t leaf = addNode(prefix, length, true);
+        nodes_[split].Children[getBit(prefix, common)] = leaf;
+      }
+      setChild(parent, side, split);
+      size_++;
+      return;
+    }
+
+    setChild(parent, side, addNode(prefix, length, true));
+    size_++;
+  }
+
+  // Returns true if any prefix in the trie covers the address
+  bool Contains(uint32_t address) const {
+    int32_t current = root_;
+    while (current != -1) {
+      const Node &node = nodes_[current];
+      if (((address ^ node.Prefix) & getMask(node.Length)) != 0) {
+        return false;
+      }
+      if (node.IsListed) {
+        return true;
+      }
+      current = node.Children[getBit(address, node.Length)];
+    }
+    return false;
+  }
+
+  size_t GetSize() const {
+    return size_;
+  }
+
+  // Parses "a.b.c.d" or "a.b.c.d/length" into a host byte order address.
+  // Anything else in the text, even a space, makes it fail
+  static bool ParseCidr(const std::string &text, uint32_t &out_address,
+    uint8_t &out_length) {
+    const char *position = text.c_str();
+    uint32_t address = 0;
+    for (int i = 0; i < 4; i++) {
+      if (i != 0 && *position++ != '.') {
+        return false;
+      }
+      uint32_t octet;
+      if (!readNumber(position, 255, octet)) {
+        return false;
+      }
+      address = (address << 8) | octet;
+    }
+
+    uint32_t length = 32;
+    if (*position == '/' && !readNumber(++position, 32, length)) {
+      return false;
+    }
+    if (position != text.c_str() + text.size()) {
+      return false;
+    }
+
+    out_address = address;
+    out_length = static_cast<uint8_t>(length);
+    return true;
+  }
+};
+
+// A deny list of IPv4 addresses and CIDR ranges which any thread can check
+// without locking. Reloading builds a new trie off to the side and publishes
+// it, so checks never wait on a reload
+// Example:
+//    IpFilter filter;
+//    filter.SetFile("deny.txt"); // One address or range per line
+//    filter.Refresh(is_loaded, count); // Call again to pick up changes
+//    if (filter.IsDenied(address)) { ... }
+class IpFilter {
+  RcuPointer<IpPrefixTrie> trie_;
+
+  std::mutex file_mutex_;
+  std::string file_path_;
+  time_t file_time_;
+  off_t file_size_;
+  bool is_file_loaded_;
+
+public:
+  IpFilter() : file_time_(0), file_size_(0), is_file_loaded_(false) {
+  }
+
+  // Returns true if the address, in host byte order, is on the list
+  bool IsDenied(uint32_t address) {
+    RcuReadLock read_lock;
+    return trie_.Read()->Contains(address);
+  }
+
+  // Replaces the list
+  void Publish(IpPrefixTrie trie) {
+    trie_.Publish(std::move(trie));
+  }
+
+  // Reads the list from a file, one address or range per line. Empty lines
+  // and anything after a # are skipped. Returns false and keeps the current
+  // list if the file can't be read or a line isn't an address
+  bool LoadFile(const std::string &path, size_t &out_count) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+      return false;
+    }
+
+    IpPrefixTrie trie;
+    std::string line;
+    while (std::getline(file, line)) {
+      line = line.substr(0, line.find('#'));
+      size_t begin = line.find_first_not_of(" \t\r");
+      if (begin == std::string::npos) {
+        continue;
+      }
+      line = line.substr(begin, line.find_last_not_of(" \t\r") - begin + 1);
+
+      uint32_t address;
+      uint8_t length;
+      if (!IpPrefixTrie::ParseCidr(line, address, length)) {
+        return false;
+      }
+      trie.Add(address, length);
+    }
+
+    out_count = trie.GetSize();
+    Publish(std::move(trie));
+    return true;
+  }
+
+  // Sets the file which Refresh loads from
+  void SetFile(const std::string &path) {
+    std::lock_guard<std::mutex> file_lock(file_mutex_);
+    file_path_ = path;
+    is_file_loaded_ = false;
+  }
+
+  // Reloads the file if it changed since it was last looked at. Returns true
+  // if it changed, out_is_loaded tells whether the new list is in use and
+  // out_count how many entries it has
+  bool Refresh(bool &out_is_loaded, size_t &out_count) {
+    std::lock_guard<std::mutex> file_lock(file_mutex_);
+    if (file_path_.empty()) {
+      return false;
+    }
+
+    struct stat file_info;
+    if (stat(file_path_.c_str(), &file_info) != 0) {
+      return false;
+    }
+    if (is_file_loaded_ && file_info.st_mtime == file_time_
+      && file_info.st_size == file_size_) {
+      return false;
+    }
+
+    // Remember the file even if loading fails, so a broken file is only
+    // reported once per change
+    file_time_ = file_info.st_mtime;
+    file_size_ = file_info.st_size;
+    is_file_loaded_ = true;
+    out_is_loaded = LoadFile(file_path_, out_count);
+    return true;
+  }
+};
+}
+
+#endif // jchat_lib_ip_filter_hpp_
@@ -0,0 +1,92 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_mpsc_queue_hpp_
+#define jchat_lib_mpsc_queue_hpp_
+
+// Required libraries
+#include <atomic>
+#include <utility>
+#include <stdint.h>
+
+#ifndef JCHAT_CACHE_LINE_SIZE
+#define JCHAT_CACHE_LINE_SIZE 64
+#endif // JCHAT_CACHE_LINE_SIZE
+
+namespace jchat {
+// An unbounded queue for passing values from any number of threads to one
+// thread without locks. Pushing never fails or waits. A value is popped after
+// every value whose push finished before its push started, so values pushed
+// by one thread, or by threads taking turns, keep their order
+// Example:
+//    MpscQueue<int> queue;
+//    // Any thread
+//    queue.Push(5);
+//    // Consumer thread
+//    int value;
+//    if (queue.TryPop(value)) { ... }
+template<typename _TValue>
+class MpscQueue {
+  struct Node {
+    std::atomic<Node *> Next;
+    _TValue Value;
+  };
+
+  // Producers swap themselves in at head_ and then link the node they
+  // replaced to theirs, the consumer follows the links from tail_. tail_ is
+  // the node before the oldest value, its own value was already popped
+  uint8_t head_padding_[JCHAT_CACHE_LINE_SIZE];
+  std::atomic<Node *> head_;
+  uint8_t tail_padding_[JCHAT_CACHE_LINE_SIZE];
+  Node *tail_;
+  uint8_t end_padding_[JCHAT_CACHE_LINE_SIZE];
+
+public:
+  MpscQueue() {
+    Node *node = new Node();
+    node->Next = nullptr;
+    head_ = node;
+    tail_ = node;
+  }
+
+  // NOTE: Nothing may be pushing anymore
+  ~MpscQueue() {
+    _TValue value;
+    while (TryPop(value)) {
+    }
+    delete tail_;
+  }
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  // Can be called from any thread
+  void Push(_TValue value) {
+    Node *node = new Node();
+    node->Next.store(nullptr, std::memory_order_relaxed);
+    node->Value = std::move(value);
+    Node *previous = head_.exchange(node, std::memory_order_acq_rel);
+    previous->Next.store(node, std::memory_order_release);
+  }
+
+  // Called by the consumer, fails if the queue is empty. A push which hasn't
+  // linked its node yet holds back the values pushed after it until it has
+  bool TryPop(_TValue &out_value) {
+    Node *next = tail_->Next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    out_value = std::move(next->Value);
+    delete tail_;
+    tail_ = next;
+    return true;
+  }
+};
+}
+
+#endif // jchat_lib_mpsc_queue_hpp_
@@ -0,0 +1,260 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_rcu_hpp_
+#define jchat_lib_rcu_hpp_
+
+// Required libraries
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <stdint.h>
+
+#ifndef JCHAT_RCU_READER_LIMIT
+#define JCHAT_RCU_READER_LIMIT 1024 // The most threads which can read at once
+#endif // JCHAT_RCU_READER_LIMIT
+
+#ifndef JCHAT_CACHE_LINE_SIZE
+#define JCHAT_CACHE_LINE_SIZE 64
+#endif // JCHAT_CACHE_LINE_SIZE
+
+namespace jchat {
+// Epoch based read-copy-update. Readers announce the epoch they started in
+// and never wait, writers publish a new version of the data and retire the
+// old one, which is only deleted once every reader which could still see it
+// has finished. Use RcuPointer and RcuReadLock rather than this directly
+class Rcu {
+  struct Reader {
+    std::atomic<uint64_t> Epoch; // 0 while the thread isn't reading
+    std::atomic<bool> IsUsed;
+    uint8_t Padding[JCHAT_CACHE_LINE_SIZE];
+  };
+
+  struct Retired {
+    uint64_t Epoch;
+    std::function<void()> Deleter;
+  };
+
+  // Gives every reading thread its own reader, which is handed back when the
+  // thread exits
+  struct ThreadReader {
+    Reader *Slot;
+    uint32_t Depth;
+
+    ThreadReader() : Slot(nullptr), Depth(0) {
+    }
+
+    ~ThreadReader() {
+      if (Slot != nullptr) {
+        Slot->Epoch = 0;
+        Slot->IsUsed = false;
+      }
+    }
+  };
+
+  Reader readers_[JCHAT_RCU_READER_LIMIT];
+  std::atomic<size_t> reader_count_;
+  std::atomic<uint64_t> epoch_;
+  std::vector<Retired> retired_;
+  std::mutex retired_mutex_;
+
+  Rcu() : reader_count_(0), epoch_(1) {
+    for (size_t i = 0; i < JCHAT_RCU_READER_LIMIT; i++) {
+      readers_[i].Epoch = 0;
+      readers_[i].IsUsed = false;
+    }
+  }
+
+  ~Rcu() {
+    for (auto &retired : retired_) {
+      retired.Deleter();
+    }
+  }
+
+  static ThreadReader &getThreadReader() {
+    static thread_local ThreadReader thread_reader;
+    return thread_reader;
+  }
+
+  Reader *acquireReader() {
+    while (true) {
+      for (size_t i = 0; i < JCHAT_RCU_READER_LIMIT; i++) {
+        bool is_used = false;
+        if (!readers_[i].IsUsed && readers_[i].IsUsed.compare_exchange_strong(
+          is_used, true)) {
+          size_t reader_count = reader_count_;
+          while (reader_count <= i && !reader_count_.compare_exchange_weak(
+            reader_count, i + 1)) {
+          }
+          return &readers_[i];
+        }
+      }
+      // Every reader is taken, wait for a thread to exit
+      std::this_thread::yield();
+    }
+  }
+
+  // The oldest epoch a reader is still in, or the current one if there are no
+  // readers
+  uint64_t getOldestEpoch() {
+    uint64_t oldest_epoch = epoch_;
+    size_t reader_count = reader_count_;
+    for (size_t i = 0; i < reader_count; i++) {
+      uint64_t epoch = readers_[i].Epoch;
+      if (epoch != 0 && epoch < oldest_epoch) {
+        oldest_epoch = epoch;
+      }
+    }
+    return oldest_epoch;
+  }
+
+public:
+  static Rcu &Get() {
+    static Rcu rcu;
+    return rcu;
+  }
+
+  // Read sections can be nested, only the outermost one announces an epoch
+  void ReadLock() {
+    ThreadReader &thread_reader = getThreadReader();
+    if (thread_reader.Depth++ > 0) {
+      return;
+    }
+    if (thread_reader.Slot == nullptr) {
+      thread_reader.Slot = acquireReader();
+    }
+    thread_reader.Slot->Epoch = epoch_.load();
+  }
+
+  void ReadUnlock() {
+    ThreadReader &thread_reader = getThreadReader();
+    if (--thread_reader.Depth > 0) {
+      return;
+    }
+    thread_reader.Slot->Epoch.store(0, std::memory_order_release);
+  }
+
+  // Deletes something which was unpublished, once no reader can see it
+  // anymore. NOTE: It must be unpublished before it's retired
+  void Retire(std::function<void()> deleter) {
+    // Readers which start from here on can't find it
+    uint64_t retire_epoch = epoch_.fetch_add(1) + 1;
+
+    retired_mutex_.lock();
+    Retired retired = { retire_epoch, std::move(deleter) };
+    retired_.push_back(std::move(retired));
+    retired_mutex_.unlock();
+
+    Reclaim();
+  }
+
+  // Deletes everything retired which no reader can see anymore
+  void Reclaim() {
+    std::vector<Retired> reclaimed;
+    uint64_t oldest_epoch = getOldestEpoch();
+
+    retired_mutex_.lock();
+    for (size_t i = 0; i < retired_.size();) {
+      if (retired_[i].Epoch <= oldest_epoch) {
+        reclaimed.push_back(std::move(retired_[i]));
+        retired_[i] = std::move(retired_.back());
+        retired_.pop_back();
+        continue;
+      }
+      i++;
+    }
+    retired_mutex_.unlock();
+
+    // Run the deleters without the lock, they may retire more
+    for (auto &retired : reclaimed) {
+      retired.Deleter();
+    }
+  }
+};
+
+// Marks a read section, whatever is read through an RcuPointer stays valid
+// until the section ends
+// Example:
+//    {
+//      RcuReadLock read_lock;
+//      const Users *users = users_.Read();
+//      ...
+//    }
+class RcuReadLock {
+public:
+  RcuReadLock() {
+    Rcu::Get().ReadLock();
+  }
+
+  ~RcuReadLock() {
+    Rcu::Get().ReadUnlock();
+  }
+
+  RcuReadLock(const RcuReadLock &) = delete;
+  RcuReadLock &operator=(const RcuReadLock &) = delete;
+};
+
+// Holds a value which many threads read and few change. Readers get the
+// current version without taking a lock, writers copy it, change the copy and
+// publish it, one writer at a time
+template<typename _TValue>
+class RcuPointer {
+  std::atomic<_TValue *> value_;
+  std::mutex write_mutex_;
+
+public:
+  RcuPointer() : value_(new _TValue()) {
+  }
+
+  // NOTE: Nothing may be reading the pointer anymore
+  ~RcuPointer() {
+    delete value_.load();
+  }
+
+  // Returns the current version. NOTE: This must be called inside a read
+  // section, and the version is only valid until the section ends
+  const _TValue *Read() {
+    return value_.load(std::memory_order_acquire);
+  }
+
+  // Calls the function with a copy of the current version, and publishes the
+  // copy if the function returns true. Returns what the function returned
+  template<typename _TFunction>
+  bool Update(_TFunction function) {
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    _TValue *old_value = value_.load(std::memory_order_relaxed);
+    _TValue *new_value = new _TValue(*old_value);
+    if (!function(*new_value)) {
+      delete new_value;
+      return false;
+    }
+    value_.store(new_value);
+
+    Rcu::Get().Retire([old_value]() {
+      delete old_value;
+    });
+    return true;
+  }
+
+  // Replaces the current version with a new one built by the caller
+  void Publish(_TValue value) {
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    _TValue *old_value = value_.load(std::memory_order_relaxed);
+    value_.store(new _TValue(std::move(value)));
+
+    Rcu::Get().Retire([old_value]() {
+      delete old_value;
+    });
+  }
+};
+}
+
+#endif // jchat_lib_rcu_hpp_
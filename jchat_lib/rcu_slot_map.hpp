@@ -0,0 +1,187 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_rcu_slot_map_hpp_
+#define jchat_lib_rcu_slot_map_hpp_
+
+// Required libraries
+#include "rcu.hpp"
+#include "slot_map.hpp"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+#ifndef JCHAT_RCU_SLOT_MAP_SEGMENT_SIZE
+#define JCHAT_RCU_SLOT_MAP_SEGMENT_SIZE 1024 // Must be a power of two
+#endif // JCHAT_RCU_SLOT_MAP_SEGMENT_SIZE
+
+#ifndef JCHAT_RCU_SLOT_MAP_SEGMENT_LIMIT
+#define JCHAT_RCU_SLOT_MAP_SEGMENT_LIMIT 4096
+#endif // JCHAT_RCU_SLOT_MAP_SEGMENT_LIMIT
+
+namespace jchat {
+// A SlotMap of shared values which any thread can look up without locking.
+// The slots are kept in segments which never move once they're allocated. A
+// lookup reads the slot's generation before and after its value, so it never
+// returns a value which took the place of the one the handle refers to, and
+// removed values are retired through Rcu, so a reader can keep using what it
+// found until its read section ends. NOTE: Only one thread at a time may
+// insert and remove
+// Example:
+//    RcuSlotMap<std::string> names;
+//    SlotHandle handle = names.Insert(std::make_shared<std::string>("John"));
+//    {
+//      RcuReadLock read_lock;
+//      std::string *name = names.Get(handle); // "John"
+//    }
+//    names.Remove(handle);
+template<typename _TValue>
+class RcuSlotMap {
+  struct Slot {
+    std::atomic<uint32_t> Generation;
+    std::atomic<const std::shared_ptr<_TValue> *> Value; // nullptr if free
+  };
+
+  struct Segment {
+    Slot Slots[JCHAT_RCU_SLOT_MAP_SEGMENT_SIZE];
+  };
+
+  std::atomic<Segment *> segments_[JCHAT_RCU_SLOT_MAP_SEGMENT_LIMIT];
+  std::vector<uint32_t> free_slots_;
+  uint32_t capacity_;
+  std::atomic<size_t> size_;
+
+  Slot *getSlot(uint32_t index) {
+    if (index >= static_cast<uint64_t>(JCHAT_RCU_SLOT_MAP_SEGMENT_SIZE)
+      * JCHAT_RCU_SLOT_MAP_SEGMENT_LIMIT) {
+      return nullptr;
+    }
+    Segment *segment = segments_[index / JCHAT_RCU_SLOT_MAP_SEGMENT_SIZE]
+      .load(std::memory_order_acquire);
+    if (segment == nullptr) {
+      return nullptr;
+    }
+    return &segment->Slots[index & (JCHAT_RCU_SLOT_MAP_SEGMENT_SIZE - 1)];
+  }
+
+  // NOTE: This must be called inside a read section
+  const std::shared_ptr<_TValue> *find(SlotHandle handle) {
+    Slot *slot = getSlot(handle.Index);
+    if (slot == nullptr || slot->Generation != handle.Generation) {
+      return nullptr;
+    }
+    const std::shared_ptr<_TValue> *value = slot->Value;
+    if (value == nullptr || slot->Generation != handle.Generation) {
+      return nullptr;
+    }
+    return value;
+  }
+
+public:
+  RcuSlotMap() : capacity_(0), size_(0) {
+    for (size_t i = 0; i < JCHAT_RCU_SLOT_MAP_SEGMENT_LIMIT; i++) {
+      segments_[i] = nullptr;
+    }
+  }
+
+  // NOTE: Nothing may be reading the map anymore
+  ~RcuSlotMap() {
+    for (size_t i = 0; i < JCHAT_RCU_SLOT_MAP_SEGMENT_LIMIT; i++) {
+      Segment *segment = segments_[i];
+      if (segment == nullptr) {
+        continue;
+      }
+      for (auto &slot : segment->Slots) {
+        delete slot.Value.load();
+      }
+      delete segment;
+    }
+  }
+
+  // Returns an invalid handle if every slot is taken
+  SlotHandle Insert(const std::shared_ptr<_TValue> &value) {
+    uint32_t index;
+    if (!free_slots_.empty()) {
+      index = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      if (capacity_ == static_cast<uint64_t>(JCHAT_RCU_SLOT_MAP_SEGMENT_SIZE)
+        * JCHAT_RCU_SLOT_MAP_SEGMENT_LIMIT) {
+        return SlotHandle();
+      }
+      index = capacity_++;
+      if ((index & (JCHAT_RCU_SLOT_MAP_SEGMENT_SIZE - 1)) == 0) {
+        Segment *segment = new Segment();
+        for (auto &slot : segment->Slots) {
+          slot.Generation = 1;
+          slot.Value = nullptr;
+        }
+        segments_[index / JCHAT_RCU_SLOT_MAP_SEGMENT_SIZE].store(segment,
+          std::memory_order_release);
+      }
+    }
+
+    Slot &slot = *getSlot(index);
+    slot.Value = new std::shared_ptr<_TValue>(value);
+    size_++;
+    return SlotHandle(index, slot.Generation);
+  }
+
+  bool Remove(SlotHandle handle) {
+    Slot *slot = getSlot(handle.Index);
+    if (slot == nullptr || slot->Generation != handle.Generation) {
+      return false;
+    }
+    const std::shared_ptr<_TValue> *value = slot->Value;
+    if (value == nullptr) {
+      return false;
+    }
+
+    // Clear the value before moving on to the next generation, so a reader
+    // which sees the new generation never sees the old value. 0 is skipped,
+    // it's reserved for invalid handles
+    slot->Value = nullptr;
+    uint32_t generation = handle.Generation + 1;
+    slot->Generation = generation == 0 ? 1 : generation;
+    free_slots_.push_back(handle.Index);
+    size_--;
+
+    Rcu::Get().Retire([value]() {
+      delete value;
+    });
+    return true;
+  }
+
+  // Returns the value the handle refers to, or nullptr if it was removed.
+  // NOTE: This must be called inside a read section, and the value is only
+  // kept alive until the section ends
+  _TValue *Get(SlotHandle handle) {
+    const std::shared_ptr<_TValue> *value = find(handle);
+    return value != nullptr ? value->get() : nullptr;
+  }
+
+  // Takes a reference to the value the handle refers to, this is safe to
+  // call from any thread
+  bool Get(SlotHandle handle, std::shared_ptr<_TValue> &out_value) {
+    RcuReadLock read_lock;
+    const std::shared_ptr<_TValue> *value = find(handle);
+    if (value == nullptr) {
+      return false;
+    }
+    out_value = *value;
+    return true;
+  }
+
+  size_t GetSize() {
+    return size_;
+  }
+};
+}
+
+#endif // jchat_lib_rcu_slot_map_hpp_
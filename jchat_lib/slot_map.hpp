@@ -0,0 +1,139 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_slot_map_hpp_
+#define jchat_lib_slot_map_hpp_
+
+// Required libraries
+#include <vector>
+#include <stdint.h>
+
+namespace jchat {
+// Refers to a value stored in a SlotMap. Slots are reused once their value is
+// removed, the generation tells the values which used the same slot apart so
+// that a handle to a removed value never finds the one that replaced it. A
+// default constructed handle never refers to anything
+struct SlotHandle {
+  uint32_t Index;
+  uint32_t Generation;
+
+  SlotHandle() : Index(0), Generation(0) {
+  }
+
+  SlotHandle(uint32_t index, uint32_t generation) : Index(index),
+    Generation(generation) {
+  }
+
+  bool IsValid() const {
+    return Generation != 0;
+  }
+
+  bool operator==(const SlotHandle &handle) const {
+    return Index == handle.Index && Generation == handle.Generation;
+  }
+
+  bool operator!=(const SlotHandle &handle) const {
+    return !(*this == handle);
+  }
+
+  // Lets handles be used as keys in ordered containers
+  bool operator<(const SlotHandle &handle) const {
+    return Index < handle.Index
+      || (Index == handle.Index && Generation < handle.Generation);
+  }
+};
+
+// Stores values in a vector of slots and hands out handles to them. Inserting,
+// looking up and removing a value are all O(1). NOTE: This isn't thread safe
+// Example:
+//    SlotMap<std::string> names;
+//    SlotHandle handle = names.Insert("John");
+//    std::string *name = names.Get(handle); // "John"
+//    names.Remove(handle);
+//    name = names.Get(handle); // nullptr
+template<typename _TValue>
+class SlotMap {
+  struct Slot {
+    _TValue Value;
+    uint32_t Generation;
+    bool IsUsed;
+  };
+
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+  size_t size_;
+
+public:
+  SlotMap() : size_(0) {
+  }
+
+  SlotHandle Insert(const _TValue &value) {
+    uint32_t index;
+    if (!free_slots_.empty()) {
+      index = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      index = static_cast<uint32_t>(slots_.size());
+      Slot slot;
+      slot.Generation = 1;
+      slot.IsUsed = false;
+      slots_.push_back(slot);
+    }
+
+    Slot &slot = slots_[index];
+    slot.Value = value;
+    slot.IsUsed = true;
+    size_++;
+
+    return SlotHandle(index, slot.Generation);
+  }
+
+  bool Remove(SlotHandle handle) {
+    if (!Contains(handle)) {
+      return false;
+    }
+
+    // Move on to the next generation so that the handle goes stale, skipping
+    // 0 which is reserved for invalid handles
+    Slot &slot = slots_[handle.Index];
+    slot.Value = _TValue();
+    slot.IsUsed = false;
+    if (++slot.Generation == 0) {
+      slot.Generation = 1;
+    }
+    free_slots_.push_back(handle.Index);
+    size_--;
+
+    return true;
+  }
+
+  // Returns the value the handle refers to, or nullptr if it was removed
+  _TValue *Get(SlotHandle handle) {
+    if (!Contains(handle)) {
+      return nullptr;
+    }
+    return &slots_[handle.Index].Value;
+  }
+
+  bool Contains(SlotHandle handle) {
+    return handle.Index < slots_.size() && slots_[handle.Index].IsUsed
+      && slots_[handle.Index].Generation == handle.Generation;
+  }
+
+  size_t GetSize() {
+    return size_;
+  }
+
+  // The number of slots, handles index into [0, GetCapacity())
+  size_t GetCapacity() {
+    return slots_.size();
+  }
+};
+}
+
+#endif // jchat_lib_slot_map_hpp_
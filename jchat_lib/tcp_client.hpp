@@ -1,296 +1,783 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#ifndef jchat_lib_tcp_client_hpp_
-#define jchat_lib_tcp_client_hpp_
-
-// Required libraries
-#include "platform.h"
-#include "event.hpp"
-#include "buffer.hpp"
-#include "ip_endpoint.hpp"
-#include <chrono>
-#include <thread>
-#if defined(OS_LINUX) || defined(OS_OSX) || defined(OS_UNIX)
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <sys/socket.h>
-#include <netinet/tcp.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <errno.h>
-
-#ifndef __SOCKET__
-#define __SOCKET__
-typedef int SOCKET;
-#endif // __SOCKET__
-
-#ifndef SOCKET_ERROR
-#define SOCKET_ERROR -1
-#endif // SOCKET_ERROR
-
-#ifndef __CLOSE_SOCKET__
-#define __CLOSE_SOCKET__
-#define closesocket(socket_fd) close(socket_fd)
-#endif // __CLOSE_SOCKET__
-
-#elif defined(OS_WIN)
-#define WIN32_LEAN_AND_MEAN
-#include <WinSock2.h>
-
-// Platform/Compiler patches
-#if defined(__CYGWIN__) || defined(__MINGW32__)
-#if defined(FIONBIO)
-#undef FIONBIO
-#define FIONBIO 0x8004667E
-#endif
-#endif
-#endif
-
-#ifndef JCHAT_TCP_CLIENT_BUFFER_SIZE
-#define JCHAT_TCP_BUFFER_SIZE 8192
-#endif // JCHAT_TCP_CLIENT_BUFFER_SIZE
-
-namespace jchat {
-class TcpServer;
-class TcpClient {
-  friend class TcpServer;
-
-  const char *hostname_;
-  uint16_t port_;
-  bool is_connected_;
-  bool is_internal_;
-  SOCKET client_socket_;
-  IPEndpoint client_endpoint_;
-  IPEndpoint remote_endpoint_;
-  std::thread worker_thread_;
-  std::vector<uint8_t> read_buffer_;
-
-#if defined(OS_WIN)
-  WSADATA wsa_data_;
-#endif
-
-  void worker_loop() {
-    fd_set socket_set;
-    while (is_connected_) {
-      // Clear the socket set
-      FD_ZERO(&socket_set);
-
-      // Add the client to the set
-      FD_SET(client_socket_, &socket_set);
-
-      // Check if an activity was completed on the client socket
-      int32_t socket_activity = select(client_socket_ + 1, &socket_set, NULL,
-        NULL, NULL);
-
-      // Ensure select didn't fail
-      if (socket_activity == SOCKET_ERROR && errno == EINTR) {
-        continue;
-      }
-
-      // Check if there was some operation completed on the client socket
-      if (FD_ISSET(client_socket_, &socket_set)) {
-        int32_t read_bytes = recv(client_socket_, (char *)read_buffer_.data(),
-          read_buffer_.size(), 0);
-        bool disconnect_client = false;
-        if (read_bytes > 0 && read_bytes < JCHAT_TCP_BUFFER_SIZE) {
-          Buffer buffer(read_buffer_.data(), read_bytes);
-          if (!OnDataReceived(buffer)) {
-            disconnect_client = true;
-          }
-        } else {
-          disconnect_client = true;
-        }
-        if (disconnect_client) {
-          is_connected_ = false;
-          closesocket(client_socket_);
-          OnDisconnected();
-        }
-      }
-
-      // Sleep
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
-  }
-
-public:
-  TcpClient(const char *hostname, uint16_t port)
-    : hostname_(hostname), port_(port), client_socket_(0),
-    remote_endpoint_(hostname, port), is_connected_(false),
-    is_internal_(false) {
-    read_buffer_.resize(JCHAT_TCP_BUFFER_SIZE);
-
-#if defined(OS_WIN)
-    // Initialize Winsock
-    WSAStartup(MAKEWORD(2, 2), &wsa_data_);
-#endif
-
-    // Get remote address info
-    addrinfo *result = nullptr;
-    addrinfo hints;
-
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_protocol = IPPROTO_TCP;
-    hints.ai_flags = AI_PASSIVE;
-
-    int return_value = getaddrinfo(hostname, std::to_string(port).c_str(),
-      &hints, &result);
-    if (return_value != SOCKET_ERROR) {
-      for (addrinfo *ptr = result; ptr != NULL; ptr = ptr->ai_next) {
-        if (ptr->ai_family == AF_INET) {
-          sockaddr_in *endpoint_info = (sockaddr_in *)ptr->ai_addr;
-          remote_endpoint_.SetAddress(ntohl(endpoint_info->sin_addr.s_addr));
-          break;
-        }
-      }
-    }
-
-     freeaddrinfo(result);
-  }
-
-  // NOTE: For internal usage only!
-  TcpClient(SOCKET client_socket, sockaddr_in client_endpoint,
-    sockaddr_in server_endpoint) : client_socket_(client_socket),
-    client_endpoint_(client_endpoint), remote_endpoint_(server_endpoint),
-    is_connected_(true), is_internal_(true) {
-    read_buffer_.resize(JCHAT_TCP_BUFFER_SIZE);
-
-#if defined(OS_LINUX) || defined(OS_OSX) || defined(OS_UNIX)
-  	uint32_t flags = fcntl(client_socket, F_GETFL, 0);
-  	if (flags != SOCKET_ERROR) {
-  	  flags |= O_NONBLOCK;
-  	  fcntl(client_socket, F_SETFL, flags);
-  	}
-#elif defined(OS_WIN)
-#if defined(__CYGWIN__) || defined(__MINGW32__)
-    unsigned int blocking = 1;
-#else
-    u_long blocking = 1;
-#endif
-    ioctlsocket(client_socket, FIONBIO, &blocking);
-#endif
-  }
-
-  ~TcpClient() {
-    if (is_connected_) {
-      is_connected_ = false;
-      if (!is_internal_) {
-        worker_thread_.join();
-      }
-      closesocket(client_socket_);
-#if defined(OS_WIN)
-      // Cleanup Winsock
-      WSACleanup();
-#endif
-    }
-  }
-
-  bool Connect() {
-    if (is_connected_ || is_internal_) {
-      return false;
-    }
-
-    if ((client_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP))
-      == SOCKET_ERROR) {
-      return false;
-    }
-
-    sockaddr_in remote_endpoint = remote_endpoint_.GetSocketEndpoint();
-    if (connect(client_socket_, (const sockaddr *)&remote_endpoint,
-      sizeof(remote_endpoint)) == SOCKET_ERROR) {
-      closesocket(client_socket_);
-      return false;
-    }
-
-    sockaddr_in client_endpoint;
-    socklen_t client_endpoint_size = sizeof(client_endpoint);
-    if (getsockname(client_socket_, (sockaddr *)&client_endpoint,
-      &client_endpoint_size) == SOCKET_ERROR) {
-      closesocket(client_socket_);
-      return false;
-    }
-    client_endpoint_.SetSocketEndpoint(client_endpoint);
-
-#if defined(OS_LINUX) || defined(OS_OSX) || defined(OS_UNIX)
-  	uint32_t flags = fcntl(client_socket_, F_GETFL, 0);
-  	if (flags != SOCKET_ERROR) {
-  	  flags |= O_NONBLOCK;
-  		if (fcntl(client_socket_, F_SETFL, flags) == SOCKET_ERROR) {
-  		  closesocket(client_socket_);
-  		  return false;
-  		}
-  	} else {
-#elif defined(OS_WIN)
-#if defined(__CYGWIN__) || defined(__MINGW32__)
-    unsigned int blocking = 1;
-#else
-    u_long blocking = 1;
-#endif
-    if (ioctlsocket(client_socket_, FIONBIO, &blocking) == SOCKET_ERROR) {
-#endif
-      closesocket(client_socket_);
-      return false;
-    }
-
-	is_connected_ = true;
-    worker_thread_ = std::thread(&TcpClient::worker_loop, this);
-
-    OnConnected();
-
-    return true;
-  }
-
-  bool Disconnect() {
-    if (!is_connected_ || is_internal_) {
-      return false;
-    }
-
-    is_connected_ = false;
-    worker_thread_.join();
-    closesocket(client_socket_);
-
-    OnDisconnected();
-
-    return true;
-  }
-
-  bool Send(Buffer &buffer) {
-    if (is_internal_ || !is_connected_) {
-      return false;
-    }
-
-    return send(client_socket_, (const char *)buffer.GetBuffer(),
-      buffer.GetSize(), 0) != SOCKET_ERROR;
-  }
-
-  IPEndpoint GetLocalEndpoint() {
-    if (is_internal_) {
-      return remote_endpoint_;
-    } else {
-      return client_endpoint_;
-    }
-  }
-
-  IPEndpoint GetRemoteEndpoint() {
-    if (is_internal_) {
-      return client_endpoint_;
-    } else {
-      return remote_endpoint_;
-    }
-  }
-
-  // NOTE: These are not intended to be used in combination with TcpServer
-  Event<> OnConnected;
-  Event<> OnDisconnected;
-  Event<Buffer &> OnDataReceived;
-};
-}
-
-#endif // jchat_lib_tcp_client_hpp_
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_tcp_client_hpp_
+#define jchat_lib_tcp_client_hpp_
+
+// Required libraries
+#include "platform.h"
+#include "event.hpp"
+#include "buffer.hpp"
+#include "ip_endpoint.hpp"
+#include "io_uring.hpp"
+#include "slot_map.hpp"
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#if defined(OS_LINUX) || defined(OS_OSX) || defined(OS_UNIX)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#ifndef __SOCKET__
+#define __SOCKET__
+typedef int SOCKET;
+#endif // __SOCKET__
+
+#ifndef SOCKET_ERROR
+#define SOCKET_ERROR -1
+#endif // SOCKET_ERROR
+
+#ifndef __CLOSE_SOCKET__
+#define __CLOSE_SOCKET__
+#define closesocket(socket_fd) close(socket_fd)
+#endif // __CLOSE_SOCKET__
+
+#elif defined(OS_WIN)
+#define WIN32_LEAN_AND_MEAN
+#include <WinSock2.h>
+
+// Platform/Compiler patches
+#if defined(__CYGWIN__) || defined(__MINGW32__)
+#if defined(FIONBIO)
+#undef FIONBIO
+#define FIONBIO 0x8004667E
+#endif
+#endif
+#endif
+
+#ifndef JCHAT_TCP_CLIENT_BUFFER_SIZE
+#define JCHAT_TCP_BUFFER_SIZE 8192
+#endif // JCHAT_TCP_CLIENT_BUFFER_SIZE
+
+#ifndef JCHAT_TCP_SELECT_TIMEOUT
+#define JCHAT_TCP_SELECT_TIMEOUT 10 // Milliseconds
+#endif // JCHAT_TCP_SELECT_TIMEOUT
+
+// Writing to a socket which the peer has closed shouldn't raise SIGPIPE
+#if defined(OS_LINUX)
+#define JCHAT_TCP_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define JCHAT_TCP_SEND_FLAGS 0
+#endif
+
+#ifndef JCHAT_TCP_SEND_CHUNK_LIMIT
+#define JCHAT_TCP_SEND_CHUNK_LIMIT 16
+#endif // JCHAT_TCP_SEND_CHUNK_LIMIT
+
+// The most queued frames written with a single call
+#ifndef JCHAT_TCP_SEND_FRAME_LIMIT
+#define JCHAT_TCP_SEND_FRAME_LIMIT 64
+#endif // JCHAT_TCP_SEND_FRAME_LIMIT
+
+// Tells the socket more data follows right away, so it doesn't push out a
+// partial segment
+#if defined(MSG_MORE)
+#define JCHAT_TCP_SEND_MORE MSG_MORE
+#else
+#define JCHAT_TCP_SEND_MORE 0
+#endif
+
+namespace jchat {
+// Identifies a client connected to a TcpServer, see TcpServer::GetClient
+typedef SlotHandle ConnectionHandle;
+
+// A piece of data to send. Data made of several pieces, such as a header and
+// a body, is sent as a list of these in one call so that the pieces don't
+// have to be copied into one buffer first
+struct SendChunk {
+  const uint8_t *Data;
+  size_t Size;
+};
+
+// Data which is encoded once and can then be queued for any number of clients
+// without being copied, see TcpServer::Send. NOTE: A frame mustn't change
+// once it has been sent
+typedef std::shared_ptr<const std::vector<uint8_t>> SharedFrame;
+
+// Which lane data is queued in. Control data overtakes whatever bulk data is
+// still queued, so replies and moderation aren't held up behind chat, and
+// bulk data is what a client which falls behind loses first, see
+// TcpServer::SetSlowConsumerPolicy
+enum SendPriority : uint8_t {
+  kSendPriority_Control,
+  kSendPriority_Bulk
+};
+
+class TcpServer;
+class TcpClient : public std::enable_shared_from_this<TcpClient> {
+  friend class TcpServer;
+
+  const char *hostname_;
+  uint16_t port_;
+  bool is_connected_;
+  bool is_internal_;
+  SOCKET client_socket_;
+  std::mutex send_mutex_;
+  uint32_t reactor_index_;
+  size_t reactor_position_;
+  ConnectionHandle handle_;
+  bool use_fast_open_;
+  IPEndpoint client_endpoint_;
+  IPEndpoint remote_endpoint_;
+  std::thread worker_thread_;
+  std::vector<uint8_t> read_buffer_;
+
+  // Data is accumulated here as it's received, whoever handles it consumes as
+  // much as it can and the rest is kept until more data arrives
+  Buffer receive_buffer_;
+
+  struct QueuedFrame {
+    SharedFrame Frame;
+    size_t Position; // How much of the frame has been sent
+    SendPriority Priority;
+  };
+
+  // Data which the socket couldn't take yet, it's sent in order once the
+  // socket becomes writable again. Shared frames are queued as they are, so
+  // queueing one only costs a pointer. The frames before send_control_end_
+  // are control frames and the frames which had started sending when they
+  // were queued, bulk frames are queued behind them. NOTE: Guarded by
+  // send_mutex_, the size is also read without it
+  std::deque<QueuedFrame> send_queue_;
+  std::atomic<size_t> send_queue_size_;
+  size_t send_control_end_;
+
+  // Set while the client waits for its reactor to write what was queued, see
+  // TcpServer::SetCoalesceBudget. NOTE: Guarded by send_mutex_
+  bool send_scheduled_;
+
+  // Set while bulk frames are refused because the client fell behind,
+  // see TcpServer::SetSlowConsumerPolicy. NOTE: Guarded by send_mutex_
+  bool is_fanout_stopped_;
+  // Set once the server shut the socket down for falling too far behind
+  bool is_send_shutdown_;
+
+  // Used by a server reactor to take turns between its clients, see
+  // TcpServer::SetReadBudget. frame_budget_ is what's left of the current
+  // turn, has_deferred_frames_ is set when the handler stopped with complete
+  // frames left over, and is_read_ready_ while the client waits on the
+  // reactor's ready list. NOTE: Only used by the reactor
+  uint32_t frame_budget_;
+  bool has_deferred_frames_;
+  bool is_read_ready_;
+
+#if defined(JCHAT_IO_URING)
+  // Used when the client belongs to a server reactor running on io_uring.
+  // Sends are queued and submitted by the reactor, the frames at the front of
+  // the queue are sent from in place while more are queued behind them, the
+  // kernel reads them through uring_send_vectors_. NOTE: Guarded by
+  // send_mutex_
+  bool uses_io_uring_;
+  iovec uring_send_vectors_[JCHAT_TCP_SEND_FRAME_LIMIT];
+  msghdr uring_send_message_;
+  size_t uring_send_count_; // The frames in flight
+
+  // The number of operations the kernel hasn't completed yet, the client has
+  // to stay alive until they have. NOTE: Only used by the reactor
+  uint32_t uring_operations_;
+
+  // Set while the client's receive is being cancelled, and while it stays
+  // stopped until the client has worked through its backlog. NOTE: Only used
+  // by the reactor
+  bool uring_receive_cancelled_;
+  bool uring_receive_paused_;
+#endif
+
+#if defined(OS_WIN)
+  WSADATA wsa_data_;
+#endif
+
+  static bool isWouldBlock() {
+#if defined(OS_WIN)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    // A fast open connection is only made by the first send, which reports
+    // EINPROGRESS if the data couldn't go out with the SYN
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS;
+#endif
+  }
+
+  // NOTE: send_mutex_ must be held when calling these
+  size_t getSendQueueSize() {
+    return send_queue_size_.load(std::memory_order_relaxed);
+  }
+
+  // The number of frames at the front of the queue which have started
+  // sending, nothing may be queued in front of them
+  size_t getSendingCount() {
+    size_t sending_count = 0;
+    if (!send_queue_.empty() && send_queue_.front().Position > 0) {
+      sending_count = 1;
+    }
+#if defined(JCHAT_IO_URING)
+    sending_count = std::max(sending_count, uring_send_count_);
+#endif
+    return sending_count;
+  }
+
+  // Queues what's left of a frame after the position, control frames go
+  // behind the other control frames but in front of the bulk frames
+  void pushFrame(const SharedFrame &frame, size_t position,
+    SendPriority priority = kSendPriority_Control) {
+    if (position >= frame->size()) {
+      return;
+    }
+    QueuedFrame queued_frame = { frame, position, priority };
+    if (priority == kSendPriority_Bulk) {
+      send_queue_.push_back(std::move(queued_frame));
+    } else {
+      size_t index = std::max(send_control_end_, getSendingCount());
+      send_queue_.insert(send_queue_.begin() + index,
+        std::move(queued_frame));
+      send_control_end_ = index + 1;
+    }
+    send_queue_size_ += frame->size() - position;
+  }
+
+  // Queues a copy of the chunks as one frame
+  void pushFrame(const SendChunk *chunks, size_t chunk_count,
+    SendPriority priority = kSendPriority_Control) {
+    auto frame = std::make_shared<std::vector<uint8_t>>();
+    for (size_t i = 0; i < chunk_count; i++) {
+      frame->insert(frame->end(), chunks[i].Data,
+        chunks[i].Data + chunks[i].Size);
+    }
+    pushFrame(frame, 0, priority);
+  }
+
+  // Points the chunks at the front of the queue, returns how many were filled
+  size_t peekFrames(SendChunk *chunks, size_t chunk_limit) {
+    size_t chunk_count = 0;
+    for (auto &queued_frame : send_queue_) {
+      if (chunk_count == chunk_limit) {
+        break;
+      }
+      chunks[chunk_count].Data = queued_frame.Frame->data()
+        + queued_frame.Position;
+      chunks[chunk_count].Size = queued_frame.Frame->size()
+        - queued_frame.Position;
+      chunk_count++;
+    }
+    return chunk_count;
+  }
+
+  // Drops bulk frames, oldest first, until the queue is no bigger than the
+  // target size. Frames which have started sending are kept. Returns the
+  // number of frames dropped
+  size_t dropFrames(size_t target_size) {
+    size_t kept_count = getSendingCount();
+    size_t control_end = send_control_end_;
+    size_t dropped_count = 0;
+    size_t write_index = kept_count;
+    for (size_t i = kept_count; i < send_queue_.size(); i++) {
+      QueuedFrame &queued_frame = send_queue_[i];
+      if (send_queue_size_ > target_size
+        && queued_frame.Priority == kSendPriority_Bulk) {
+        send_queue_size_ -= queued_frame.Frame->size() - queued_frame.Position;
+        if (i < control_end) {
+          send_control_end_--;
+        }
+        dropped_count++;
+        continue;
+      }
+      if (write_index != i) {
+        send_queue_[write_index] = std::move(queued_frame);
+      }
+      write_index++;
+    }
+    send_queue_.resize(write_index);
+    return dropped_count;
+  }
+
+  // Drops the data which was sent from the front of the queue
+  void popFrames(size_t sent_size) {
+    send_queue_size_ -= sent_size;
+    while (sent_size > 0) {
+      QueuedFrame &queued_frame = send_queue_.front();
+      size_t frame_size = queued_frame.Frame->size() - queued_frame.Position;
+      if (sent_size < frame_size) {
+        queued_frame.Position += sent_size;
+        return;
+      }
+      sent_size -= frame_size;
+      send_queue_.pop_front();
+      if (send_control_end_ > 0) {
+        send_control_end_--;
+      }
+    }
+  }
+
+  // Sends as much of the chunks as the socket will take with a single call,
+  // returns the amount of bytes sent or SOCKET_ERROR
+  int32_t sendChunks(const SendChunk *chunks, size_t chunk_count,
+    int32_t flags = 0) {
+#if defined(OS_WIN)
+    WSABUF buffers[JCHAT_TCP_SEND_FRAME_LIMIT];
+    for (size_t i = 0; i < chunk_count; i++) {
+      buffers[i].buf = (CHAR *)chunks[i].Data;
+      buffers[i].len = (ULONG)chunks[i].Size;
+    }
+    DWORD sent_bytes = 0;
+    if (WSASend(client_socket_, buffers, (DWORD)chunk_count, &sent_bytes, 0,
+      NULL, NULL) == SOCKET_ERROR) {
+      return SOCKET_ERROR;
+    }
+    return (int32_t)sent_bytes;
+#else
+    iovec buffers[JCHAT_TCP_SEND_FRAME_LIMIT];
+    for (size_t i = 0; i < chunk_count; i++) {
+      buffers[i].iov_base = (void *)chunks[i].Data;
+      buffers[i].iov_len = chunks[i].Size;
+    }
+    msghdr message = {};
+    message.msg_iov = buffers;
+    message.msg_iovlen = chunk_count;
+    return sendmsg(client_socket_, &message, JCHAT_TCP_SEND_FLAGS | flags);
+#endif
+  }
+
+  // Sends data, or queues whatever the socket can't take right now. Returns
+  // false if the socket failed
+  bool queueSend(const SendChunk *chunks, size_t chunk_count,
+    SendPriority priority = kSendPriority_Control) {
+    if (chunk_count > JCHAT_TCP_SEND_CHUNK_LIMIT) {
+      return false;
+    }
+
+    // Keep our own copy of the chunks so that they can be moved past the data
+    // which has been sent
+    SendChunk pending_chunks[JCHAT_TCP_SEND_CHUNK_LIMIT];
+    for (size_t i = 0; i < chunk_count; i++) {
+      pending_chunks[i] = chunks[i];
+    }
+
+    // Only send straight away if nothing is queued, otherwise the data would
+    // end up out of order
+    size_t first_chunk = 0;
+    if (getSendQueueSize() == 0) {
+      while (first_chunk < chunk_count) {
+        int32_t sent_bytes = sendChunks(pending_chunks + first_chunk,
+          chunk_count - first_chunk);
+        if (sent_bytes == SOCKET_ERROR) {
+          if (!isWouldBlock()) {
+            return false;
+          }
+          break;
+        }
+
+        // Skip the chunks which were sent completely, and the part of the
+        // chunk which was sent partially
+        size_t sent_size = sent_bytes;
+        while (first_chunk < chunk_count
+          && sent_size >= pending_chunks[first_chunk].Size) {
+          sent_size -= pending_chunks[first_chunk].Size;
+          first_chunk++;
+        }
+        if (first_chunk < chunk_count) {
+          pending_chunks[first_chunk].Data += sent_size;
+          pending_chunks[first_chunk].Size -= sent_size;
+        }
+      }
+      if (first_chunk == chunk_count) {
+        return true;
+      }
+    }
+
+    pushFrame(pending_chunks + first_chunk, chunk_count - first_chunk,
+      priority);
+
+    return true;
+  }
+
+  bool queueSend(const uint8_t *data, size_t size) {
+    SendChunk chunk = { data, size };
+    return queueSend(&chunk, 1);
+  }
+
+  // Sends a shared frame, or queues the frame itself from wherever the socket
+  // stopped taking it. Returns false if the socket failed
+  bool queueFrame(const SharedFrame &frame,
+    SendPriority priority = kSendPriority_Control) {
+    size_t position = 0;
+    if (getSendQueueSize() == 0) {
+      while (position < frame->size()) {
+        SendChunk chunk = { frame->data() + position,
+          frame->size() - position };
+        int32_t sent_bytes = sendChunks(&chunk, 1);
+        if (sent_bytes == SOCKET_ERROR) {
+          if (!isWouldBlock()) {
+            return false;
+          }
+          break;
+        }
+        position += sent_bytes;
+      }
+    }
+
+    pushFrame(frame, position, priority);
+
+    return true;
+  }
+
+  // Sends as much of the queued data as the socket will take, several frames
+  // at a time. Returns false if the socket failed
+  bool flushSendQueue() {
+    SendChunk chunks[JCHAT_TCP_SEND_FRAME_LIMIT];
+    while (getSendQueueSize() > 0) {
+      size_t chunk_count = peekFrames(chunks, JCHAT_TCP_SEND_FRAME_LIMIT);
+      int32_t sent_bytes = sendChunks(chunks, chunk_count,
+        chunk_count < send_queue_.size() ? JCHAT_TCP_SEND_MORE : 0);
+      if (sent_bytes == SOCKET_ERROR) {
+        return isWouldBlock();
+      }
+      popFrames(sent_bytes);
+    }
+    return true;
+  }
+
+  void worker_loop() {
+    fd_set socket_set;
+    fd_set write_socket_set;
+    while (is_connected_) {
+      // Clear the socket sets
+      FD_ZERO(&socket_set);
+      FD_ZERO(&write_socket_set);
+
+      // Add the client to the set, and wait for it to be writable if there's
+      // data queued
+      FD_SET(client_socket_, &socket_set);
+      send_mutex_.lock();
+      if (getSendQueueSize() > 0) {
+        FD_SET(client_socket_, &write_socket_set);
+      }
+      send_mutex_.unlock();
+
+      // Check if an activity was completed on the client socket, time out so
+      // that data queued in the meantime is picked up
+      timeval timeout;
+      timeout.tv_sec = 0;
+      timeout.tv_usec = JCHAT_TCP_SELECT_TIMEOUT * 1000;
+      int32_t socket_activity = select(client_socket_ + 1, &socket_set,
+        &write_socket_set, NULL, &timeout);
+
+      // Ensure select didn't fail
+      if (socket_activity == SOCKET_ERROR && errno == EINTR) {
+        continue;
+      }
+
+      bool disconnect_client = false;
+
+      // Check if there was some operation completed on the client socket
+      if (FD_ISSET(client_socket_, &socket_set)) {
+        int32_t read_bytes = recv(client_socket_, (char *)read_buffer_.data(),
+          read_buffer_.size(), 0);
+        if (read_bytes > 0) {
+          receive_buffer_.Append(read_buffer_.data(), read_bytes);
+          receive_buffer_.Rewind();
+          if (!OnDataReceived(receive_buffer_)) {
+            disconnect_client = true;
+          }
+          receive_buffer_.Compact();
+        } else {
+          disconnect_client = true;
+        }
+      }
+
+      // Send whatever was queued now that the socket is writable
+      if (!disconnect_client && FD_ISSET(client_socket_, &write_socket_set)) {
+        send_mutex_.lock();
+        disconnect_client = !flushSendQueue();
+        send_mutex_.unlock();
+      }
+
+      if (disconnect_client) {
+        send_mutex_.lock();
+        is_connected_ = false;
+        closesocket(client_socket_);
+        send_mutex_.unlock();
+        OnDisconnected();
+      }
+
+      // Sleep
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+public:
+  TcpClient(const char *hostname, uint16_t port)
+    : hostname_(hostname), port_(port), client_socket_(0),
+    remote_endpoint_(hostname, port), is_connected_(false),
+    is_internal_(false), reactor_index_(0),
+    reactor_position_(0), use_fast_open_(false), send_queue_size_(0),
+    send_control_end_(0), send_scheduled_(false), is_fanout_stopped_(false),
+    is_send_shutdown_(false), frame_budget_(UINT32_MAX),
+    has_deferred_frames_(false), is_read_ready_(false) {
+    read_buffer_.resize(JCHAT_TCP_BUFFER_SIZE);
+#if defined(JCHAT_IO_URING)
+    uses_io_uring_ = false;
+    uring_send_count_ = 0;
+    uring_operations_ = 0;
+    uring_receive_cancelled_ = false;
+    uring_receive_paused_ = false;
+#endif
+
+#if defined(OS_WIN)
+    // Initialize Winsock
+    WSAStartup(MAKEWORD(2, 2), &wsa_data_);
+#endif
+
+    // Get remote address info
+    addrinfo *result = nullptr;
+    addrinfo hints;
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    hints.ai_flags = AI_PASSIVE;
+
+    int return_value = getaddrinfo(hostname, std::to_string(port).c_str(),
+      &hints, &result);
+    if (return_value != SOCKET_ERROR) {
+      for (addrinfo *ptr = result; ptr != NULL; ptr = ptr->ai_next) {
+        if (ptr->ai_family == AF_INET) {
+          sockaddr_in *endpoint_info = (sockaddr_in *)ptr->ai_addr;
+          remote_endpoint_.SetAddress(ntohl(endpoint_info->sin_addr.s_addr));
+          break;
+        }
+      }
+    }
+
+     freeaddrinfo(result);
+  }
+
+  // NOTE: For internal usage only!
+  TcpClient(SOCKET client_socket, sockaddr_in client_endpoint,
+    sockaddr_in server_endpoint, bool is_non_blocking = false)
+    : client_socket_(client_socket),
+    client_endpoint_(client_endpoint), remote_endpoint_(server_endpoint),
+    is_connected_(true), is_internal_(true), reactor_index_(0),
+    reactor_position_(0), use_fast_open_(false), send_queue_size_(0),
+    send_control_end_(0), send_scheduled_(false), is_fanout_stopped_(false),
+    is_send_shutdown_(false), frame_budget_(UINT32_MAX),
+    has_deferred_frames_(false), is_read_ready_(false) {
+    read_buffer_.resize(JCHAT_TCP_BUFFER_SIZE);
+#if defined(JCHAT_IO_URING)
+    uses_io_uring_ = false;
+    uring_send_count_ = 0;
+    uring_operations_ = 0;
+    uring_receive_cancelled_ = false;
+    uring_receive_paused_ = false;
+#endif
+
+    // Skip making the socket non-blocking if it was accepted that way
+    if (is_non_blocking) {
+      return;
+    }
+#if defined(OS_LINUX) || defined(OS_OSX) || defined(OS_UNIX)
+  	uint32_t flags = fcntl(client_socket, F_GETFL, 0);
+  	if (flags != SOCKET_ERROR) {
+  	  flags |= O_NONBLOCK;
+  	  fcntl(client_socket, F_SETFL, flags);
+  	}
+#elif defined(OS_WIN)
+#if defined(__CYGWIN__) || defined(__MINGW32__)
+    unsigned int blocking = 1;
+#else
+    u_long blocking = 1;
+#endif
+    ioctlsocket(client_socket, FIONBIO, &blocking);
+#endif
+  }
+
+  ~TcpClient() {
+    if (is_connected_) {
+      is_connected_ = false;
+      if (!is_internal_) {
+        worker_thread_.join();
+      }
+      closesocket(client_socket_);
+#if defined(OS_WIN)
+      // Cleanup Winsock
+      WSACleanup();
+#endif
+    }
+  }
+
+  bool Connect() {
+    if (is_connected_ || is_internal_) {
+      return false;
+    }
+
+    if ((client_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP))
+      == SOCKET_ERROR) {
+      return false;
+    }
+
+#if defined(TCP_FASTOPEN_CONNECT)
+    // Connecting is deferred until the first send, whose data then goes out
+    // with the SYN if the server has given us a fast open cookie before
+    if (use_fast_open_) {
+      int32_t fast_open = 1;
+      setsockopt(client_socket_, IPPROTO_TCP, TCP_FASTOPEN_CONNECT,
+        &fast_open, sizeof(fast_open));
+    }
+#endif
+
+    sockaddr_in remote_endpoint = remote_endpoint_.GetSocketEndpoint();
+    if (connect(client_socket_, (const sockaddr *)&remote_endpoint,
+      sizeof(remote_endpoint)) == SOCKET_ERROR) {
+      closesocket(client_socket_);
+      return false;
+    }
+
+    sockaddr_in client_endpoint;
+    socklen_t client_endpoint_size = sizeof(client_endpoint);
+    if (getsockname(client_socket_, (sockaddr *)&client_endpoint,
+      &client_endpoint_size) == SOCKET_ERROR) {
+      closesocket(client_socket_);
+      return false;
+    }
+    client_endpoint_.SetSocketEndpoint(client_endpoint);
+
+#if defined(OS_LINUX) || defined(OS_OSX) || defined(OS_UNIX)
+  	uint32_t flags = fcntl(client_socket_, F_GETFL, 0);
+  	if (flags != SOCKET_ERROR) {
+  	  flags |= O_NONBLOCK;
+  		if (fcntl(client_socket_, F_SETFL, flags) == SOCKET_ERROR) {
+  		  closesocket(client_socket_);
+  		  return false;
+  		}
+  	} else {
+#elif defined(OS_WIN)
+#if defined(__CYGWIN__) || defined(__MINGW32__)
+    unsigned int blocking = 1;
+#else
+    u_long blocking = 1;
+#endif
+    if (ioctlsocket(client_socket_, FIONBIO, &blocking) == SOCKET_ERROR) {
+#endif
+      closesocket(client_socket_);
+      return false;
+    }
+
+	is_connected_ = true;
+    worker_thread_ = std::thread(&TcpClient::worker_loop, this);
+
+    OnConnected();
+
+    return true;
+  }
+
+  bool Disconnect() {
+    if (!is_connected_ || is_internal_) {
+      return false;
+    }
+
+    is_connected_ = false;
+    worker_thread_.join();
+    closesocket(client_socket_);
+
+    OnDisconnected();
+
+    return true;
+  }
+
+  // Uses TCP Fast Open for the next connection, so that the first data sent
+  // doesn't have to wait for the handshake. Linux only
+  bool SetFastOpen(bool use_fast_open) {
+    if (is_connected_ || is_internal_) {
+      return false;
+    }
+    use_fast_open_ = use_fast_open;
+    return true;
+  }
+
+  bool Send(Buffer &buffer) {
+    std::lock_guard<std::mutex> send_lock(send_mutex_);
+    if (is_internal_ || !is_connected_) {
+      return false;
+    }
+
+    return queueSend(buffer.GetBuffer(), buffer.GetSize());
+  }
+
+  // Sends the chunks one after another as if they were a single buffer, at
+  // most JCHAT_TCP_SEND_CHUNK_LIMIT chunks can be sent at once
+  bool Send(const SendChunk *chunks, size_t chunk_count) {
+    std::lock_guard<std::mutex> send_lock(send_mutex_);
+    if (is_internal_ || !is_connected_) {
+      return false;
+    }
+
+    return queueSend(chunks, chunk_count);
+  }
+
+  // Returns the amount of data waiting for the socket to become writable,
+  // this is safe to call from any thread
+  size_t GetSendQueueSize() {
+    return getSendQueueSize();
+  }
+
+  // Returns the handle of a client accepted by a TcpServer
+  ConnectionHandle GetHandle() {
+    return handle_;
+  }
+
+  // Used by the data handlers of a TcpServer before they dispatch a complete
+  // frame. Returns false once the client has used up its turn, the handler
+  // should then stop and leave the frame in the buffer, it's called again
+  // with the rest on the client's next turn
+  bool TakeFrameBudget() {
+    if (frame_budget_ == 0) {
+      has_deferred_frames_ = true;
+      return false;
+    }
+    frame_budget_--;
+    return true;
+  }
+
+  IPEndpoint GetLocalEndpoint() {
+    if (is_internal_) {
+      return remote_endpoint_;
+    } else {
+      return client_endpoint_;
+    }
+  }
+
+  IPEndpoint GetRemoteEndpoint() {
+    if (is_internal_) {
+      return client_endpoint_;
+    } else {
+      return remote_endpoint_;
+    }
+  }
+
+  // NOTE: These are not intended to be used in combination with TcpServer
+  Event<> OnConnected;
+  Event<> OnDisconnected;
+
+  // NOTE: The buffer holds all the data received that hasn't been consumed
+  // yet. Handlers should leave the buffer position after the last byte they
+  // consumed, anything after it is kept for the next call
+  Event<Buffer &> OnDataReceived;
+};
+}
+
+#endif // jchat_lib_tcp_client_hpp_
@@ -1,286 +1,1900 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#ifndef jchat_lib_tcp_server_hpp_
-#define jchat_lib_tcp_server_hpp_
-
-// Required libraries
-#include "tcp_client.hpp"
-
-#ifndef JCHAT_TCP_SERVER_BACKLOG
-#define JCHAT_TCP_SERVER_BACKLOG 50
-#endif // JCHAT_TCP_SERVER_BACKLOG
-
-namespace jchat {
-class TcpServer {
-  const char *hostname_;
-  uint16_t port_;
-  bool is_listening_;
-  SOCKET listen_socket_;
-  IPEndpoint listen_endpoint_;
-  std::vector<TcpClient *> accepted_clients_;
-  std::mutex accepted_clients_mutex_;
-  std::thread worker_thread_;
-
-#if defined(OS_WIN)
-  WSADATA wsa_data_;
-#endif
-
-  void worker_loop() {
-    fd_set socket_set;
-    SOCKET max_socket = 0;
-    while (is_listening_) {
-      // Clear the socket set
-      FD_ZERO(&socket_set);
-
-      // Add the listener to the set
-      FD_SET(listen_socket_, &socket_set);
-      max_socket = listen_socket_;
-
-      // Add all clients to the set
-      accepted_clients_mutex_.lock();
-      for (auto tcp_client : accepted_clients_) {
-        if (tcp_client->is_connected_) {
-          FD_SET(tcp_client->client_socket_, &socket_set);
-
-          // If the client socket is the largest socket, set it so
-          if (tcp_client->client_socket_ > max_socket) {
-            max_socket = tcp_client->client_socket_;
-          }
-        }
-      }
-      accepted_clients_mutex_.unlock();
-
-      // Check if an activity was completed on any of those sockets
-      int32_t socket_activity = select(max_socket + 1, &socket_set, NULL, NULL,
-        NULL);
-
-      // Ensure select didn't fail
-      if (socket_activity == SOCKET_ERROR && errno == EINTR) {
-        continue;
-      }
-
-      // Check if a new connection is awaiting
-      if (FD_ISSET(listen_socket_, &socket_set)) {
-        sockaddr_in client_endpoint;
-#if defined(OS_LINUX) || defined(OS_OSX) || defined(OS_UNIX)
-        uint32_t client_endpoint_size = sizeof(client_endpoint);
-#elif defined(OS_WIN)
-        int32_t client_endpoint_size = sizeof(client_endpoint);
-#endif
-        SOCKET client_socket = accept(listen_socket_,
-          (sockaddr *)&client_endpoint, &client_endpoint_size);
-        if (client_socket != SOCKET_ERROR) {
-          TcpClient *tcp_client = new TcpClient(client_socket, client_endpoint,
-            listen_endpoint_.GetSocketEndpoint());
-          accepted_clients_mutex_.lock();
-          accepted_clients_.push_back(tcp_client);
-          accepted_clients_mutex_.unlock();
-
-          OnClientConnected(*tcp_client);
-        }
-      }
-
-      // Check if there was some operation completed on another socket
-      accepted_clients_mutex_.lock();
-      for (auto tcp_client = accepted_clients_.begin();
-        tcp_client != accepted_clients_.end();) {
-        if (FD_ISSET((*tcp_client)->client_socket_, &socket_set)) {
-          int32_t read_bytes = recv((*tcp_client)->client_socket_,
-            (char *)(*tcp_client)->read_buffer_.data(),
-            (*tcp_client)->read_buffer_.size(), 0);
-          bool disconnect_client = false;
-          if (read_bytes > 0 && read_bytes < JCHAT_TCP_BUFFER_SIZE) {
-            Buffer buffer((*tcp_client)->read_buffer_.data(), read_bytes);
-            if (!OnDataReceived(**tcp_client, buffer)) {
-              disconnect_client = true;
-            }
-          } else {
-            disconnect_client = true;
-          }
-          if (disconnect_client) {
-            (*tcp_client)->is_connected_ = false;
-            closesocket((*tcp_client)->client_socket_);
-            OnClientDisconnected(**tcp_client);
-            delete *tcp_client;
-            tcp_client = accepted_clients_.erase(tcp_client);
-            continue;
-          }
-        }
-        ++tcp_client;
-      }
-      accepted_clients_mutex_.unlock();
-
-      // Sleep
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
-  }
-
-public:
-  TcpServer(const char *hostname, uint16_t port)
-    : hostname_(hostname), port_(port), is_listening_(false),
-    listen_socket_(0), listen_endpoint_("0.0.0.0", port) {
-#if defined(OS_WIN)
-    // Initialize Winsock
-    WSAStartup(MAKEWORD(2, 2), &wsa_data_);
-#endif
-
-    // Get remote address info
-    addrinfo *result = nullptr;
-    addrinfo hints;
-
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_protocol = IPPROTO_TCP;
-    hints.ai_flags = AI_PASSIVE;
-
-    int return_value = getaddrinfo(hostname, std::to_string(port).c_str(),
-      &hints, &result);
-    if (return_value != SOCKET_ERROR) {
-      for (addrinfo *ptr = result; ptr != NULL; ptr = ptr->ai_next) {
-        if (ptr->ai_family == AF_INET) {
-          sockaddr_in *endpoint_info = (sockaddr_in *)ptr->ai_addr;
-          listen_endpoint_.SetAddress(ntohl(endpoint_info->sin_addr.s_addr));
-          break;
-        }
-      }
-    }
-
-     freeaddrinfo(result);
-  }
-
-  ~TcpServer() {
-    if (is_listening_) {
-      is_listening_ = false;
-      worker_thread_.join();
-      closesocket(listen_socket_);
-
-#if defined(OS_WIN)
-      // Cleanup Winsock
-      WSACleanup();
-#endif
-    }
-
-    if (!accepted_clients_.empty()) {
-      for (auto tcp_client : accepted_clients_) {
-        delete tcp_client;
-      }
-      accepted_clients_.clear();
-    }
-  }
-
-  bool Start() {
-	  if (is_listening_) {
-		  return false;
-	  }
-
-	  if ((listen_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP))
-		  == SOCKET_ERROR) {
-		  return false;
-	  }
-
-	  sockaddr_in listen_endpoint = listen_endpoint_.GetSocketEndpoint();
-	  if (bind(listen_socket_, (const sockaddr *)&listen_endpoint,
-		  sizeof(listen_endpoint)) == SOCKET_ERROR) {
-		  closesocket(listen_socket_);
-		  return false;
-	  }
-
-	  if (listen(listen_socket_, JCHAT_TCP_SERVER_BACKLOG) == SOCKET_ERROR) {
-		  closesocket(listen_socket_);
-		  return false;
-	  }
-
-#if defined(OS_LINUX) || defined(OS_OSX) || defined(OS_UNIX)
-	  uint32_t flags = fcntl(listen_socket_, F_GETFL, 0);
-	  if (flags != SOCKET_ERROR) {
-		  flags |= O_NONBLOCK;
-		  if (fcntl(listen_socket_, F_SETFL, flags) == SOCKET_ERROR) {
-			  closesocket(listen_socket_);
-			  return false;
-		  }
-	  } else {
-#elif defined(OS_WIN)
-#if defined(__CYGWIN__) || defined(__MINGW32__)
-	    unsigned int blocking = 1;
-#else
-		  u_long blocking = 1;
-#endif
-		if (ioctlsocket(listen_socket_, FIONBIO, &blocking) == SOCKET_ERROR) {
-#endif
-      closesocket(listen_socket_);
-      return false;
-    }
-
-    is_listening_ = true;
-
-    worker_thread_ = std::thread(&TcpServer::worker_loop, this);
-
-    return true;
-  }
-
-  bool Stop() {
-    if (!is_listening_) {
-      return false;
-    }
-
-    is_listening_ = false;
-    worker_thread_.join();
-    closesocket(listen_socket_);
-
-    accepted_clients_mutex_.lock();
-    if (!accepted_clients_.empty()) {
-      for (auto tcp_client : accepted_clients_) {
-        delete tcp_client;
-      }
-      accepted_clients_.clear();
-    }
-    accepted_clients_mutex_.unlock();
-
-    return true;
-  }
-
-  bool DisconnectClient(TcpClient &tcp_client) {
-    accepted_clients_mutex_.lock();
-    for (auto client = accepted_clients_.begin();
-      client != accepted_clients_.end();) {
-      if (*client == &tcp_client) {
-        (*client)->is_connected_ = false;
-        closesocket((*client)->client_socket_);
-        OnClientDisconnected(**client);
-        accepted_clients_.erase(client);
-        accepted_clients_mutex_.unlock();
-        return true;
-      } else {
-        ++client;
-      }
-    }
-    accepted_clients_mutex_.unlock();
-    return false;
-  }
-
-  bool Send(TcpClient &tcp_client, Buffer &buffer) {
-    if (!tcp_client.is_internal_ || !tcp_client.is_connected_) {
-      return false;
-    }
-
-    return send(tcp_client.client_socket_, (const char *)buffer.GetBuffer(),
-      buffer.GetSize(), 0) != SOCKET_ERROR;
-  }
-
-  IPEndpoint GetListenEndpoint() {
-    return listen_endpoint_;
-  }
-
-  Event<TcpClient &> OnClientConnected;
-  Event<TcpClient &> OnClientDisconnected;
-  Event<TcpClient &, Buffer &> OnDataReceived;
-};
-}
-
-#endif // jchat_lib_tcp_server_hpp_
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_tcp_server_hpp_
+#define jchat_lib_tcp_server_hpp_
+
+// Required libraries
+#include "tcp_client.hpp"
+#include "mpsc_queue.hpp"
+#include "ip_filter.hpp"
+#include "executor.hpp"
+#include "rcu_slot_map.hpp"
+#include <algorithm>
+#if defined(OS_LINUX)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+#ifndef JCHAT_TCP_SERVER_BACKLOG
+#define JCHAT_TCP_SERVER_BACKLOG SOMAXCONN // Default, see SetBacklog
+#endif // JCHAT_TCP_SERVER_BACKLOG
+
+#ifndef JCHAT_TCP_SERVER_EVENT_COUNT
+#define JCHAT_TCP_SERVER_EVENT_COUNT 256
+#endif // JCHAT_TCP_SERVER_EVENT_COUNT
+
+#ifndef JCHAT_TCP_SERVER_RING_SIZE
+#define JCHAT_TCP_SERVER_RING_SIZE 1024
+#endif // JCHAT_TCP_SERVER_RING_SIZE
+
+#ifndef JCHAT_TCP_SERVER_RING_BUFFERS
+#define JCHAT_TCP_SERVER_RING_BUFFERS 512 // Must be a power of two
+#endif // JCHAT_TCP_SERVER_RING_BUFFERS
+
+// The amount of data queued for a client past which it's treated as a slow
+// consumer, and the amount it has to drain to before it stops being one. See
+// SetSendWatermarks
+#ifndef JCHAT_TCP_SERVER_SEND_HIGH_WATERMARK
+#define JCHAT_TCP_SERVER_SEND_HIGH_WATERMARK (4 * 1024 * 1024)
+#endif // JCHAT_TCP_SERVER_SEND_HIGH_WATERMARK
+
+#ifndef JCHAT_TCP_SERVER_SEND_LOW_WATERMARK
+#define JCHAT_TCP_SERVER_SEND_LOW_WATERMARK (1024 * 1024)
+#endif // JCHAT_TCP_SERVER_SEND_LOW_WATERMARK
+
+// How much a client may read (in bytes) and how many frames its handler may
+// dispatch in one turn, see SetReadBudget
+#ifndef JCHAT_TCP_SERVER_READ_BUDGET
+#define JCHAT_TCP_SERVER_READ_BUDGET (16 * 1024)
+#endif // JCHAT_TCP_SERVER_READ_BUDGET
+
+#ifndef JCHAT_TCP_SERVER_FRAME_BUDGET
+#define JCHAT_TCP_SERVER_FRAME_BUDGET 32
+#endif // JCHAT_TCP_SERVER_FRAME_BUDGET
+
+namespace jchat {
+// What happens to a client whose queued data reaches the high watermark
+enum SlowConsumerPolicy : uint8_t {
+  // Drop its oldest bulk frames until it's back at the low watermark
+  kSlowConsumerPolicy_DropOldest,
+  // Disconnect it
+  kSlowConsumerPolicy_Disconnect,
+  // Refuse bulk frames for it until it's back at the low watermark
+  kSlowConsumerPolicy_StopFanout
+};
+
+// How often the slow consumer policy had to step in
+struct SlowConsumerCounters {
+  uint64_t DroppedFrames; // Queued frames dropped to make room
+  uint64_t RefusedFrames; // Frames never queued
+  uint64_t FanoutStops; // Times a client had its fan-out stopped
+  uint64_t Disconnects; // Clients disconnected for falling behind
+};
+
+class TcpServer {
+  // Data sent to a client by a thread other than its reactor in sharded mode
+  struct ShardMessage {
+    ConnectionHandle Handle;
+    SharedFrame Frame;
+    SendPriority Priority;
+  };
+
+  // A reactor owns a listening socket, a poller and the clients accepted
+  // through them, and runs on its own thread. On Linux every reactor binds its
+  // own listening socket to the same port using SO_REUSEPORT so that the
+  // kernel spreads new connections across them
+  struct Reactor {
+    uint32_t Index;
+    SOCKET ListenSocket;
+    std::vector<std::shared_ptr<TcpClient>> Clients;
+    std::mutex ClientsMutex;
+    std::thread WorkerThread;
+
+    // The reactor's clients by handle, any thread can look them up without
+    // locking (see findClient). Only the reactor inserts and removes, or the
+    // thread stopping the server once the reactor has finished
+    RcuSlotMap<TcpClient> Connections;
+
+#if defined(OS_LINUX)
+    // The epoll instance which all the sockets are registered with, and an
+    // eventfd used to wake the worker up when we're stopping
+    int PollFd;
+    int WakeFd;
+
+    // Clients with data to send are put on PendingSends, and the reactor
+    // writes or submits the data of all of them at the end of its pass.
+    // PendingSince is when the first of them was put there
+    std::vector<std::shared_ptr<TcpClient>> PendingSends;
+    std::mutex PendingSendsMutex;
+    std::chrono::steady_clock::time_point PendingSince;
+    std::atomic<bool> HasPendingSends;
+
+    // Clients which used up their turn with data left over, they take their
+    // next turn in this order on the next pass. NOTE: Only used by the
+    // reactor
+    std::vector<std::shared_ptr<TcpClient>> ReadyClients;
+#endif
+
+#if defined(JCHAT_IO_URING)
+    // Set when the reactor runs on io_uring instead of epoll, its sends
+    // always go through PendingSends. Clients which are closed while the
+    // kernel still has operations in flight for them are kept in
+    // ClosingClients until those complete
+    IoUring *Ring;
+    uint64_t WakeCount;
+    std::vector<std::shared_ptr<TcpClient>> ClosingClients;
+#endif
+
+    // Used in sharded mode, carries the sends every other thread made to the
+    // clients of this reactor. IsInboxWoken is set once the reactor has been
+    // woken up for its inbox, so a burst of sends only wakes it once
+    MpscQueue<ShardMessage> Inbox;
+    std::atomic<bool> IsInboxWoken;
+  };
+
+#if defined(JCHAT_IO_URING)
+  // Identifies what an io_uring completion belongs to, stored in the low bits
+  // of its user data next to the client pointer
+  enum UringOperation : uint64_t {
+    kUringOperation_Accept,
+    kUringOperation_Wake,
+    kUringOperation_Receive,
+    kUringOperation_Send,
+    kUringOperation_Cancel,
+    kUringOperation_Mask = 7,
+  };
+#endif
+
+  const char *hostname_;
+  uint16_t port_;
+  bool is_listening_;
+  IPEndpoint listen_endpoint_;
+  uint32_t reactor_count_;
+  std::vector<Reactor *> reactors_;
+
+  // How other threads find a reactor by its index. When the server stops the
+  // reactors are taken out of here and retired through Rcu, so a thread which
+  // found one can keep using it until its read section ends
+  std::unique_ptr<std::atomic<Reactor *>[]> published_reactors_;
+
+  // The number of low bits of a handle's index which hold its reactor's index
+  uint32_t reactor_bits_;
+
+  bool use_io_uring_;
+  bool is_using_io_uring_;
+  bool is_sharded_;
+  uint32_t coalesce_budget_;
+  size_t read_budget_;
+  uint32_t frame_budget_;
+
+  // See SetSendWatermarks and SetSlowConsumerPolicy
+  size_t send_low_watermark_;
+  size_t send_high_watermark_;
+  SlowConsumerPolicy slow_consumer_policy_;
+  std::atomic<uint64_t> dropped_frames_;
+  std::atomic<uint64_t> refused_frames_;
+  std::atomic<uint64_t> fanout_stops_;
+  std::atomic<uint64_t> slow_disconnects_;
+
+  // Connections from these addresses are closed as soon as they're accepted
+  IpFilter ip_filter_;
+  std::atomic<uint64_t> denied_connections_;
+  int32_t backlog_;
+  int32_t defer_accept_timeout_;
+  int32_t fast_open_queue_size_;
+
+#if defined(OS_WIN)
+  WSADATA wsa_data_;
+#endif
+
+  bool openListener(Reactor &reactor) {
+    if ((reactor.ListenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP))
+      == SOCKET_ERROR) {
+      return false;
+    }
+
+#if defined(OS_LINUX)
+    int32_t reuse_port = 1;
+    if (setsockopt(reactor.ListenSocket, SOL_SOCKET, SO_REUSEPORT,
+      &reuse_port, sizeof(reuse_port)) == SOCKET_ERROR) {
+      closesocket(reactor.ListenSocket);
+      return false;
+    }
+#endif
+
+    sockaddr_in listen_endpoint = listen_endpoint_.GetSocketEndpoint();
+    if (bind(reactor.ListenSocket, (const sockaddr *)&listen_endpoint,
+      sizeof(listen_endpoint)) == SOCKET_ERROR) {
+      closesocket(reactor.ListenSocket);
+      return false;
+    }
+
+    // These are optimizations, so the listener is still usable if the system
+    // doesn't support them
+#if defined(TCP_DEFER_ACCEPT)
+    if (defer_accept_timeout_ > 0) {
+      setsockopt(reactor.ListenSocket, IPPROTO_TCP, TCP_DEFER_ACCEPT,
+        (const char *)&defer_accept_timeout_, sizeof(defer_accept_timeout_));
+    }
+#endif
+#if defined(TCP_FASTOPEN)
+    if (fast_open_queue_size_ > 0) {
+      setsockopt(reactor.ListenSocket, IPPROTO_TCP, TCP_FASTOPEN,
+        (const char *)&fast_open_queue_size_, sizeof(fast_open_queue_size_));
+    }
+#endif
+
+    if (listen(reactor.ListenSocket, backlog_) == SOCKET_ERROR) {
+      closesocket(reactor.ListenSocket);
+      return false;
+    }
+
+#if defined(OS_LINUX) || defined(OS_OSX) || defined(OS_UNIX)
+    uint32_t flags = fcntl(reactor.ListenSocket, F_GETFL, 0);
+    if (flags != SOCKET_ERROR) {
+      flags |= O_NONBLOCK;
+      if (fcntl(reactor.ListenSocket, F_SETFL, flags) == SOCKET_ERROR) {
+        closesocket(reactor.ListenSocket);
+        return false;
+      }
+    } else {
+#elif defined(OS_WIN)
+#if defined(__CYGWIN__) || defined(__MINGW32__)
+    unsigned int blocking = 1;
+#else
+    u_long blocking = 1;
+#endif
+    if (ioctlsocket(reactor.ListenSocket, FIONBIO, &blocking)
+      == SOCKET_ERROR) {
+#endif
+      closesocket(reactor.ListenSocket);
+      return false;
+    }
+
+    return true;
+  }
+
+  bool openPoller(Reactor &reactor) {
+#if defined(OS_LINUX)
+    reactor.WakeFd = SOCKET_ERROR;
+    if ((reactor.PollFd = epoll_create1(EPOLL_CLOEXEC)) == SOCKET_ERROR) {
+      return false;
+    }
+
+    if ((reactor.WakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+      == SOCKET_ERROR) {
+      closePoller(reactor);
+      return false;
+    }
+
+    // The listener is level triggered, every event drains its backlog
+    epoll_event listen_event;
+    listen_event.events = EPOLLIN;
+    listen_event.data.ptr = &reactor.ListenSocket;
+    epoll_event wake_event;
+    wake_event.events = EPOLLIN;
+    wake_event.data.ptr = &reactor.WakeFd;
+    if (epoll_ctl(reactor.PollFd, EPOLL_CTL_ADD, reactor.ListenSocket,
+      &listen_event) == SOCKET_ERROR || epoll_ctl(reactor.PollFd,
+      EPOLL_CTL_ADD, reactor.WakeFd, &wake_event) == SOCKET_ERROR) {
+      closePoller(reactor);
+      return false;
+    }
+#endif
+
+#if defined(JCHAT_IO_URING)
+    // Set up io_uring if it was asked for, if the kernel doesn't support what
+    // we need the reactor keeps using epoll
+    if (use_io_uring_) {
+      reactor.Ring = new IoUring();
+      if (!reactor.Ring->Initialize(JCHAT_TCP_SERVER_RING_SIZE)
+        || !reactor.Ring->RegisterBuffers(0, JCHAT_TCP_SERVER_RING_BUFFERS,
+        JCHAT_TCP_BUFFER_SIZE)) {
+        delete reactor.Ring;
+        reactor.Ring = nullptr;
+      }
+    }
+#endif
+    return true;
+  }
+
+  static void closePoller(Reactor &reactor) {
+#if defined(JCHAT_IO_URING)
+    if (reactor.Ring != nullptr) {
+      delete reactor.Ring;
+      reactor.Ring = nullptr;
+    }
+#endif
+#if defined(OS_LINUX)
+    if (reactor.WakeFd != SOCKET_ERROR) {
+      close(reactor.WakeFd);
+      reactor.WakeFd = SOCKET_ERROR;
+    }
+    if (reactor.PollFd != SOCKET_ERROR) {
+      close(reactor.PollFd);
+      reactor.PollFd = SOCKET_ERROR;
+    }
+#endif
+  }
+
+  void wakeWorker(Reactor &reactor) {
+#if defined(OS_LINUX)
+    uint64_t wake_count = 1;
+    write(reactor.WakeFd, &wake_count, sizeof(wake_count));
+#endif
+  }
+
+  // Accepts every connection waiting on the listener
+  void acceptClients(Reactor &reactor) {
+    while (is_listening_) {
+      sockaddr_in client_endpoint;
+#if defined(OS_LINUX) || defined(OS_OSX) || defined(OS_UNIX)
+      uint32_t client_endpoint_size = sizeof(client_endpoint);
+#elif defined(OS_WIN)
+      int32_t client_endpoint_size = sizeof(client_endpoint);
+#endif
+#if defined(OS_LINUX)
+      // Have the socket created non-blocking, which saves making it so
+      // afterwards
+      SOCKET client_socket = accept4(reactor.ListenSocket,
+        (sockaddr *)&client_endpoint, &client_endpoint_size,
+        SOCK_NONBLOCK | SOCK_CLOEXEC);
+      bool is_non_blocking = true;
+#else
+      SOCKET client_socket = accept(reactor.ListenSocket,
+        (sockaddr *)&client_endpoint, &client_endpoint_size);
+      bool is_non_blocking = false;
+#endif
+      if (client_socket == SOCKET_ERROR) {
+#if !defined(OS_WIN)
+        // The connection was reset before we got to it, move on to the next
+        if (errno == EINTR || errno == ECONNABORTED) {
+          continue;
+        }
+#endif
+        break;
+      }
+
+      if (isDenied(client_endpoint)) {
+        closesocket(client_socket);
+        continue;
+      }
+
+      addClient(reactor, client_socket, client_endpoint, is_non_blocking);
+    }
+  }
+
+  // Checks a new connection against the deny list, before anything is made
+  // for it
+  bool isDenied(const sockaddr_in &client_endpoint) {
+    if (!ip_filter_.IsDenied(ntohl(client_endpoint.sin_addr.s_addr))) {
+      return false;
+    }
+    denied_connections_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // A client's handle is the handle of its slot in its reactor's table, with
+  // the reactor's index in the low bits of the slot index. That way any
+  // thread can tell which reactor owns a client from its handle alone
+  uint32_t getReactorIndex(ConnectionHandle handle) {
+    return handle.Index & ((1u << reactor_bits_) - 1);
+  }
+
+  SlotHandle getSlotHandle(ConnectionHandle handle) {
+    return SlotHandle(handle.Index >> reactor_bits_, handle.Generation);
+  }
+
+  // Returns the reactor at the index if the server is running. NOTE: This
+  // must be called inside a read section
+  Reactor *findReactor(uint32_t reactor_index) {
+    if (reactor_index >= reactor_count_) {
+      return nullptr;
+    }
+    return published_reactors_[reactor_index].load(std::memory_order_acquire);
+  }
+
+  // Looks a client up in its reactor's table without locking. NOTE: This must
+  // be called inside a read section, and the client is only kept alive until
+  // the section ends
+  TcpClient *findClient(ConnectionHandle handle) {
+    Reactor *reactor = findReactor(getReactorIndex(handle));
+    if (reactor == nullptr) {
+      return nullptr;
+    }
+    return reactor->Connections.Get(getSlotHandle(handle));
+  }
+
+  // Registers a new client's handle and gives the client to a reactor,
+  // returns false if there's no room for it. NOTE: This must be called by the
+  // reactor, with its ClientsMutex held
+  bool insertClient(Reactor &reactor,
+    const std::shared_ptr<TcpClient> &tcp_client) {
+    SlotHandle slot_handle = reactor.Connections.Insert(tcp_client);
+    if (!slot_handle.IsValid()) {
+      return false;
+    }
+    if ((static_cast<uint64_t>(slot_handle.Index) << reactor_bits_)
+      > UINT32_MAX) {
+      reactor.Connections.Remove(slot_handle);
+      return false;
+    }
+    tcp_client->handle_ = ConnectionHandle((slot_handle.Index
+      << reactor_bits_) | reactor.Index, slot_handle.Generation);
+
+    tcp_client->reactor_index_ = reactor.Index;
+    tcp_client->reactor_position_ = reactor.Clients.size();
+    reactor.Clients.push_back(tcp_client);
+    return true;
+  }
+
+  void addClient(Reactor &reactor, SOCKET client_socket,
+    sockaddr_in client_endpoint, bool is_non_blocking) {
+    auto tcp_client = std::make_shared<TcpClient>(client_socket,
+      client_endpoint, listen_endpoint_.GetSocketEndpoint(), is_non_blocking);
+    reactor.ClientsMutex.lock();
+    if (!insertClient(reactor, tcp_client)) {
+      // The client closes its socket as it goes away
+      reactor.ClientsMutex.unlock();
+      return;
+    }
+#if defined(OS_LINUX)
+    // Register the client with the poller, edge triggered so that we're only
+    // woken up when new data arrives on the socket, or when it becomes
+    // writable again after filling up
+    epoll_event client_event;
+    client_event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    client_event.data.ptr = tcp_client.get();
+    epoll_ctl(reactor.PollFd, EPOLL_CTL_ADD, client_socket, &client_event);
+#endif
+    reactor.ClientsMutex.unlock();
+
+    OnClientConnected(*tcp_client);
+  }
+
+  // Adds data received from a client to what's left over from the previous
+  // reads, and lets the handler consume as much of it as it can. Returns false
+  // if the client should be disconnected
+  bool handleData(TcpClient &tcp_client, const uint8_t *data, size_t size) {
+    Buffer &receive_buffer = tcp_client.receive_buffer_;
+    receive_buffer.Append(data, size);
+    if (!OnDataReceived(tcp_client, receive_buffer)) {
+      return false;
+    }
+
+    // The handler carries on from the position next time. The data it
+    // consumed is only discarded once it's most of the buffer, so that a
+    // client working through a backlog a turn at a time doesn't have the
+    // backlog moved on every turn
+    if (receive_buffer.GetPosition() * 2 >= receive_buffer.GetSize()) {
+      receive_buffer.Compact();
+    }
+    return true;
+  }
+
+  // Starts a client's turn, and hands the frames its handler left over from
+  // the last one back to it. Returns false if the client should be
+  // disconnected
+  bool startTurn(TcpClient &tcp_client) {
+    tcp_client.frame_budget_ = frame_budget_ > 0 ? frame_budget_ : UINT32_MAX;
+    if (!tcp_client.has_deferred_frames_) {
+      return true;
+    }
+    tcp_client.has_deferred_frames_ = false;
+    return handleData(tcp_client, nullptr, 0);
+  }
+
+  // Takes a turn at reading a client socket, reading no more than the read
+  // budget. out_has_more is set if the turn ended with data left over, either
+  // on the socket or in frames the handler deferred. Returns false if the
+  // client should be disconnected
+  bool receiveClient(TcpClient &tcp_client, bool &out_has_more) {
+    out_has_more = false;
+    if (!startTurn(tcp_client)) {
+      return false;
+    }
+    if (tcp_client.has_deferred_frames_) {
+      out_has_more = true;
+      return true;
+    }
+
+    size_t read_budget = read_budget_ > 0 ? read_budget_ : SIZE_MAX;
+    while (read_budget > 0) {
+      int32_t read_bytes = recv(tcp_client.client_socket_,
+        (char *)tcp_client.read_buffer_.data(),
+        std::min(tcp_client.read_buffer_.size(), read_budget), 0);
+      if (read_bytes > 0) {
+        read_budget -= read_bytes;
+        if (!handleData(tcp_client, tcp_client.read_buffer_.data(),
+          read_bytes)) {
+          return false;
+        }
+        // Leave the rest on the socket until the deferred frames are done
+        if (tcp_client.has_deferred_frames_) {
+          out_has_more = true;
+          return true;
+        }
+      } else if (read_bytes == SOCKET_ERROR && TcpClient::isWouldBlock()) {
+        return true;
+#if !defined(OS_WIN)
+      } else if (read_bytes == SOCKET_ERROR && errno == EINTR) {
+        // Interrupted before anything was read, try again
+        continue;
+#endif
+      } else {
+        return false;
+      }
+#if !defined(OS_LINUX)
+      // The socket is level triggered, so if there's any more data we'll be
+      // notified about it on the next pass
+      return true;
+#endif
+    }
+
+    // The socket is edge triggered, so there won't be another event for the
+    // data which is still on it
+    out_has_more = true;
+    return true;
+  }
+
+  // Takes a client's send lock or its reactor's PendingSendsMutex. In sharded
+  // mode nothing but the reactor touches its clients' send queues and its
+  // pending sends, so the lock is left alone
+  std::unique_lock<std::mutex> lockShard(std::mutex &mutex) {
+    if (is_sharded_) {
+      return std::unique_lock<std::mutex>(mutex, std::defer_lock);
+    }
+    return std::unique_lock<std::mutex>(mutex);
+  }
+
+  // Sends the data queued for a client now that its socket is writable,
+  // returns false if the client should be disconnected
+  bool flushClient(TcpClient &tcp_client) {
+    std::unique_lock<std::mutex> send_lock = lockShard(tcp_client.send_mutex_);
+    return tcp_client.flushSendQueue();
+  }
+
+  void closeClient(Reactor &reactor, TcpClient &tcp_client) {
+    // Hold the send lock so that no other thread is sending on the socket
+    // while it's being closed
+    tcp_client.send_mutex_.lock();
+    tcp_client.is_connected_ = false;
+#if defined(OS_LINUX)
+    epoll_ctl(reactor.PollFd, EPOLL_CTL_DEL, tcp_client.client_socket_, NULL);
+#endif
+#if defined(JCHAT_IO_URING)
+    // Operations in flight keep the socket open inside the kernel, shutting it
+    // down makes them complete
+    if (tcp_client.uses_io_uring_) {
+      shutdown(tcp_client.client_socket_, SHUT_RDWR);
+    }
+#endif
+    closesocket(tcp_client.client_socket_);
+    tcp_client.send_mutex_.unlock();
+
+    OnClientDisconnected(tcp_client);
+
+    // The handle goes stale from here on. It's only released after the event
+    // so that its slot can't be reused by a new client while the old one is
+    // still being cleaned up
+    reactor.Connections.Remove(getSlotHandle(tcp_client.handle_));
+  }
+
+  // Removes a client from its reactor by moving the last client into its
+  // place. NOTE: The reactor's ClientsMutex must be held
+  void removeClient(Reactor &reactor, TcpClient &tcp_client) {
+    size_t position = tcp_client.reactor_position_;
+#if defined(JCHAT_IO_URING)
+    // Keep the client alive until the kernel is done with it
+    if (tcp_client.uring_operations_ > 0) {
+      reactor.ClosingClients.push_back(reactor.Clients[position]);
+    }
+#endif
+    if (position != reactor.Clients.size() - 1) {
+      reactor.Clients[position].swap(reactor.Clients.back());
+      reactor.Clients[position]->reactor_position_ = position;
+    }
+    reactor.Clients.pop_back();
+  }
+
+#if defined(OS_LINUX)
+  // Hands a client with queued data to its reactor, which writes the data of
+  // every client it was given at the end of its pass. NOTE: send_mutex_ must
+  // be held
+  bool scheduleSend(TcpClient &tcp_client) {
+    if (tcp_client.send_scheduled_) {
+      return true;
+    }
+    tcp_client.send_scheduled_ = true;
+
+    Reactor &reactor = *reactors_[tcp_client.reactor_index_];
+    bool wake_reactor;
+    {
+      std::unique_lock<std::mutex> pending_lock
+        = lockShard(reactor.PendingSendsMutex);
+      wake_reactor = reactor.PendingSends.empty();
+      if (wake_reactor) {
+        reactor.PendingSince = std::chrono::steady_clock::now();
+        reactor.HasPendingSends = true;
+      }
+      reactor.PendingSends.push_back(tcp_client.shared_from_this());
+    }
+
+    // The reactor handles the sends made on its own thread before it waits
+    // again, sends from other threads have to wake it up
+    if (wake_reactor
+      && std::this_thread::get_id() != reactor.WorkerThread.get_id()) {
+      wakeWorker(reactor);
+    }
+    return true;
+  }
+
+  // Writes the data queued for every client handed to the reactor, io_uring
+  // clients have their sends submitted instead
+  void submitSends(Reactor &reactor,
+    std::vector<std::shared_ptr<TcpClient>> &pending_sends) {
+    {
+      std::unique_lock<std::mutex> pending_lock
+        = lockShard(reactor.PendingSendsMutex);
+      pending_sends.swap(reactor.PendingSends);
+      reactor.HasPendingSends = false;
+    }
+
+    for (auto &tcp_client : pending_sends) {
+      std::unique_lock<std::mutex> send_lock
+        = lockShard(tcp_client->send_mutex_);
+      if (!tcp_client->is_connected_) {
+        continue;
+      }
+#if defined(JCHAT_IO_URING)
+      if (tcp_client->uses_io_uring_) {
+        startSend(reactor, *tcp_client);
+        continue;
+      }
+#endif
+      // Whatever the socket doesn't take is written once it's writable. If
+      // the socket failed, the reactor closes it once it sees it's shut down
+      tcp_client->send_scheduled_ = false;
+      if (!tcp_client->flushSendQueue()) {
+        shutdown(tcp_client->client_socket_, SHUT_RDWR);
+      }
+    }
+    pending_sends.clear();
+  }
+
+  // Returns true once the data waiting for the end of the pass has waited
+  // longer than the coalesce budget
+  bool isSendBudgetSpent(Reactor &reactor) {
+    if (coalesce_budget_ == 0 || !reactor.HasPendingSends) {
+      return false;
+    }
+    std::unique_lock<std::mutex> pending_lock
+      = lockShard(reactor.PendingSendsMutex);
+    return !reactor.PendingSends.empty()
+      && std::chrono::steady_clock::now() - reactor.PendingSince
+      >= std::chrono::microseconds(coalesce_budget_);
+  }
+
+  // Puts a client which used up its turn at the back of the ready list
+  void queueReady(Reactor &reactor, TcpClient &tcp_client) {
+    if (tcp_client.is_read_ready_) {
+      return;
+    }
+    tcp_client.is_read_ready_ = true;
+    reactor.ReadyClients.push_back(tcp_client.shared_from_this());
+  }
+
+  // Gives the clients which were on the ready list at the start of the pass
+  // their next turn, after the clients with new activity had theirs
+  void serviceReadyClients(Reactor &reactor,
+    std::vector<std::shared_ptr<TcpClient>> &ready_clients,
+    std::vector<std::shared_ptr<TcpClient>> &pending_sends) {
+    for (auto &tcp_client : ready_clients) {
+      reactor.ClientsMutex.lock();
+      tcp_client->is_read_ready_ = false;
+      if (tcp_client->is_connected_) {
+        bool has_more = false;
+        bool disconnect_client;
+#if defined(JCHAT_IO_URING)
+        if (tcp_client->uses_io_uring_) {
+          disconnect_client = !resumeUringClient(reactor, *tcp_client,
+            has_more);
+        } else
+#endif
+        disconnect_client = !receiveClient(*tcp_client, has_more);
+        if (disconnect_client) {
+          closeClient(reactor, *tcp_client);
+          removeClient(reactor, *tcp_client);
+        } else if (has_more) {
+          queueReady(reactor, *tcp_client);
+        }
+      }
+      reactor.ClientsMutex.unlock();
+
+      // Don't let a long pass hold the sends back past the budget
+      if (isSendBudgetSpent(reactor)) {
+        submitSends(reactor, pending_sends);
+      }
+    }
+    ready_clients.clear();
+  }
+#endif
+
+#if defined(JCHAT_IO_URING)
+  bool armAccept(Reactor &reactor) {
+    io_uring_sqe *sqe = reactor.Ring->GetSqe();
+    if (sqe == nullptr) {
+      return false;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = reactor.ListenSocket;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = kUringOperation_Accept;
+    return true;
+  }
+
+  bool armWake(Reactor &reactor) {
+    io_uring_sqe *sqe = reactor.Ring->GetSqe();
+    if (sqe == nullptr) {
+      return false;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = reactor.WakeFd;
+    sqe->addr = (uint64_t)&reactor.WakeCount;
+    sqe->len = sizeof(reactor.WakeCount);
+    sqe->user_data = kUringOperation_Wake;
+    return true;
+  }
+
+  // Receives into the reactor's provided buffers until the receive is
+  // stopped, either by the client disconnecting or running out of buffers
+  bool armReceive(Reactor &reactor, TcpClient &tcp_client) {
+    io_uring_sqe *sqe = reactor.Ring->GetSqe();
+    if (sqe == nullptr) {
+      return false;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = tcp_client.client_socket_;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = reactor.Ring->GetBufferGroup();
+    sqe->user_data = (uint64_t)&tcp_client | kUringOperation_Receive;
+    tcp_client.uring_operations_++;
+    return true;
+  }
+
+  // Stops a client's receive, its final completion arrives with ECANCELED
+  bool cancelReceive(Reactor &reactor, TcpClient &tcp_client) {
+    io_uring_sqe *sqe = reactor.Ring->GetSqe();
+    if (sqe == nullptr) {
+      return false;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)&tcp_client | kUringOperation_Receive;
+    sqe->user_data = kUringOperation_Cancel;
+    tcp_client.uring_receive_cancelled_ = true;
+    return true;
+  }
+
+  // Whether a client waiting for its turn has more data buffered than it may
+  // read in one, its receive is stopped until it has caught up
+  bool isUringBacklogFull(TcpClient &tcp_client) {
+    Buffer &receive_buffer = tcp_client.receive_buffer_;
+    return read_budget_ > 0 && tcp_client.has_deferred_frames_
+      && receive_buffer.GetSize() - receive_buffer.GetPosition() > read_budget_;
+  }
+
+  // Takes data io_uring received for a client. The data of a client which is
+  // waiting for its turn is only added to its backlog, so that the kernel
+  // keeps receiving for every client while each is only served its share.
+  // Returns false if the client should be disconnected
+  bool receiveUringData(Reactor &reactor, TcpClient &tcp_client,
+    const uint8_t *data, size_t size) {
+    if (tcp_client.is_read_ready_) {
+      tcp_client.receive_buffer_.Append(data, size);
+    } else {
+      tcp_client.frame_budget_ = frame_budget_ > 0 ? frame_budget_
+        : UINT32_MAX;
+      if (!handleData(tcp_client, data, size)) {
+        return false;
+      }
+      if (tcp_client.has_deferred_frames_) {
+        queueReady(reactor, tcp_client);
+      }
+    }
+    if (isUringBacklogFull(tcp_client)
+      && !tcp_client.uring_receive_cancelled_) {
+      return cancelReceive(reactor, tcp_client);
+    }
+    return true;
+  }
+
+  // Takes an io_uring client's turn from the ready list, and starts receiving
+  // again once it has caught up. Returns false if the client should be
+  // disconnected
+  bool resumeUringClient(Reactor &reactor, TcpClient &tcp_client,
+    bool &out_has_more) {
+    if (!startTurn(tcp_client)) {
+      return false;
+    }
+    out_has_more = tcp_client.has_deferred_frames_;
+    if (tcp_client.uring_receive_paused_ && !isUringBacklogFull(tcp_client)) {
+      tcp_client.uring_receive_paused_ = false;
+      return armReceive(reactor, tcp_client);
+    }
+    return true;
+  }
+
+  // Hands a client back to its reactor's next pass. It stays scheduled, so
+  // it's either on PendingSends or has a send in flight, never neither.
+  // NOTE: send_mutex_ must be held
+  void requeueSend(Reactor &reactor, TcpClient &tcp_client) {
+    std::unique_lock<std::mutex> pending_lock
+      = lockShard(reactor.PendingSendsMutex);
+    if (reactor.PendingSends.empty()) {
+      reactor.PendingSince = std::chrono::steady_clock::now();
+      reactor.HasPendingSends = true;
+    }
+    reactor.PendingSends.push_back(tcp_client.shared_from_this());
+  }
+
+  // Puts the frames at the front of the queue in flight, or retries on the
+  // next pass if the ring has no room. NOTE: send_mutex_ must be held and
+  // nothing may be in flight already
+  void startSend(Reactor &reactor, TcpClient &tcp_client) {
+    io_uring_sqe *sqe = reactor.Ring->GetSqe();
+    if (sqe == nullptr) {
+      requeueSend(reactor, tcp_client);
+      return;
+    }
+    SendChunk chunks[JCHAT_TCP_SEND_FRAME_LIMIT];
+    size_t chunk_count = tcp_client.peekFrames(chunks,
+      JCHAT_TCP_SEND_FRAME_LIMIT);
+    for (size_t i = 0; i < chunk_count; i++) {
+      tcp_client.uring_send_vectors_[i].iov_base = (void *)chunks[i].Data;
+      tcp_client.uring_send_vectors_[i].iov_len = chunks[i].Size;
+    }
+    tcp_client.uring_send_count_ = chunk_count;
+    msghdr &message = tcp_client.uring_send_message_;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = tcp_client.uring_send_vectors_;
+    message.msg_iovlen = chunk_count;
+
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = tcp_client.client_socket_;
+    sqe->addr = (uint64_t)&message;
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL
+      | (chunk_count < tcp_client.send_queue_.size() ? MSG_MORE : 0);
+    sqe->user_data = (uint64_t)&tcp_client | kUringOperation_Send;
+    tcp_client.uring_operations_++;
+  }
+
+  // Handles a completed send, and puts whatever was queued in the meantime in
+  // flight. Returns false if the client should be disconnected
+  bool completeSend(Reactor &reactor, TcpClient &tcp_client, int32_t result) {
+    std::unique_lock<std::mutex> send_lock = lockShard(tcp_client.send_mutex_);
+    if (result < 0) {
+      return false;
+    }
+    if (!tcp_client.is_connected_) {
+      return true;
+    }
+
+    // Send whatever is left, including what was queued in the meantime
+    tcp_client.uring_send_count_ = 0;
+    tcp_client.popFrames(result);
+    if (tcp_client.getSendQueueSize() > 0) {
+      startSend(reactor, tcp_client);
+      return true;
+    }
+    tcp_client.send_scheduled_ = false;
+    return true;
+  }
+
+  void acceptUringClient(Reactor &reactor, SOCKET client_socket) {
+    sockaddr_in client_endpoint;
+    socklen_t client_endpoint_size = sizeof(client_endpoint);
+    if (getpeername(client_socket, (sockaddr *)&client_endpoint,
+      &client_endpoint_size) == SOCKET_ERROR || isDenied(client_endpoint)) {
+      closesocket(client_socket);
+      return;
+    }
+
+    auto tcp_client = std::make_shared<TcpClient>(client_socket,
+      client_endpoint, listen_endpoint_.GetSocketEndpoint(), true);
+    tcp_client->uses_io_uring_ = true;
+    reactor.ClientsMutex.lock();
+    if (!insertClient(reactor, tcp_client)) {
+      // The client closes its socket as it goes away
+      reactor.ClientsMutex.unlock();
+      return;
+    }
+    bool is_receiving = armReceive(reactor, *tcp_client);
+    reactor.ClientsMutex.unlock();
+
+    OnClientConnected(*tcp_client);
+
+    if (!is_receiving) {
+      DisconnectClient(*tcp_client);
+    }
+  }
+
+  void completeOperation(Reactor &reactor, uint64_t user_data, int32_t result,
+    uint32_t flags) {
+    uint64_t operation = user_data & kUringOperation_Mask;
+    if (operation == kUringOperation_Accept) {
+      if (result >= 0) {
+        acceptUringClient(reactor, result);
+      }
+      if (!(flags & IORING_CQE_F_MORE) && is_listening_) {
+        armAccept(reactor);
+      }
+      return;
+    }
+    if (operation == kUringOperation_Wake) {
+      if (is_listening_) {
+        armWake(reactor);
+      }
+      return;
+    }
+    if (operation == kUringOperation_Cancel) {
+      return;
+    }
+
+    TcpClient *tcp_client = (TcpClient *)(user_data & ~kUringOperation_Mask);
+    std::lock_guard<std::mutex> clients_lock(reactor.ClientsMutex);
+    bool disconnect_client = false;
+    if (operation == kUringOperation_Receive) {
+      if (flags & IORING_CQE_F_BUFFER) {
+        uint16_t buffer_id = flags >> IORING_CQE_BUFFER_SHIFT;
+        if (result > 0 && tcp_client->is_connected_) {
+          disconnect_client = !receiveUringData(reactor, *tcp_client,
+            reactor.Ring->GetBuffer(buffer_id), result);
+        }
+        reactor.Ring->RecycleBuffer(buffer_id);
+      }
+
+      // Running out of buffers or being cancelled stops the receive, it's
+      // rearmed below since the buffers have been handed back by now, unless
+      // the client still has to work through its backlog
+      if (result == 0 || (result < 0 && result != -ENOBUFS
+        && result != -ECANCELED)) {
+        disconnect_client = true;
+      }
+      if (!(flags & IORING_CQE_F_MORE)) {
+        tcp_client->uring_operations_--;
+        tcp_client->uring_receive_cancelled_ = false;
+        if (!disconnect_client && tcp_client->is_connected_) {
+          if (isUringBacklogFull(*tcp_client)) {
+            tcp_client->uring_receive_paused_ = true;
+          } else {
+            disconnect_client = !armReceive(reactor, *tcp_client);
+          }
+        }
+      }
+    } else if (operation == kUringOperation_Send) {
+      tcp_client->uring_operations_--;
+      disconnect_client = !completeSend(reactor, *tcp_client, result);
+    }
+
+    if (tcp_client->is_connected_) {
+      if (disconnect_client) {
+        closeClient(reactor, *tcp_client);
+        removeClient(reactor, *tcp_client);
+      }
+    } else if (tcp_client->uring_operations_ == 0) {
+      // The kernel is done with a closed client, so it can be released
+      for (auto client = reactor.ClosingClients.begin();
+        client != reactor.ClosingClients.end(); ++client) {
+        if (client->get() == tcp_client) {
+          reactor.ClosingClients.erase(client);
+          break;
+        }
+      }
+    }
+  }
+
+  void uring_loop(Reactor *reactor) {
+    IoUring &ring = *reactor->Ring;
+    std::vector<std::shared_ptr<TcpClient>> pending_sends;
+    std::vector<std::shared_ptr<TcpClient>> ready_clients;
+    armAccept(*reactor);
+    armWake(*reactor);
+    while (is_listening_) {
+      if (is_sharded_) {
+        receiveForwardedSends(*reactor);
+      }
+      Executor::RunDeferred();
+
+      // Submit everything queued since the last pass with the same call that
+      // waits for completions, unless clients are waiting for their turn or
+      // for room on the ring, or work was deferred to the next pass
+      submitSends(*reactor, pending_sends);
+      bool is_waiting = reactor->ReadyClients.empty()
+        && !reactor->HasPendingSends && !Executor::HasDeferred();
+      if (ring.Submit(is_waiting ? 1 : 0) == SOCKET_ERROR
+        && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        break;
+      }
+      ready_clients.swap(reactor->ReadyClients);
+
+      io_uring_cqe *cqe;
+      while ((cqe = ring.PeekCqe()) != nullptr) {
+        uint64_t user_data = cqe->user_data;
+        int32_t result = cqe->res;
+        uint32_t flags = cqe->flags;
+        ring.SeenCqe();
+        completeOperation(*reactor, user_data, result, flags);
+
+        // Don't let a long pass hold the sends back past the budget
+        if (isSendBudgetSpent(*reactor)) {
+          submitSends(*reactor, pending_sends);
+        }
+      }
+
+      serviceReadyClients(*reactor, ready_clients, pending_sends);
+    }
+  }
+#endif
+
+#if defined(OS_LINUX)
+  void worker_loop(Reactor *reactor) {
+    currentServer() = this;
+    currentReactor() = reactor;
+    Executor::EnableDeferred();
+
+#if defined(JCHAT_IO_URING)
+    if (reactor->Ring != nullptr) {
+      if (reactor->Ring->Enable()) {
+        uring_loop(reactor);
+        return;
+      }
+      delete reactor->Ring;
+      reactor->Ring = nullptr;
+    }
+#endif
+
+    std::vector<epoll_event> events(JCHAT_TCP_SERVER_EVENT_COUNT);
+    std::vector<std::shared_ptr<TcpClient>> pending_sends;
+    std::vector<std::shared_ptr<TcpClient>> ready_clients;
+    while (is_listening_) {
+      Executor::RunDeferred();
+
+      // Wait for activity on any of the registered sockets, only sockets with
+      // activity are returned so the cost doesn't grow with idle clients.
+      // Don't wait if clients are waiting for their turn, or work was
+      // deferred to the next pass
+      bool is_waiting = reactor->ReadyClients.empty()
+        && !Executor::HasDeferred();
+      int32_t event_count = epoll_wait(reactor->PollFd, events.data(),
+        events.size(), is_waiting ? -1 : 0);
+
+      // Ensure epoll_wait didn't fail
+      if (event_count == SOCKET_ERROR) {
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+
+      // The clients which used up their turn on the last pass take their next
+      // one after the clients with new activity
+      ready_clients.swap(reactor->ReadyClients);
+      for (int32_t i = 0; i < event_count; i++) {
+        epoll_event &event = events[i];
+
+        // Check if new connections are awaiting
+        if (event.data.ptr == &reactor->ListenSocket) {
+          acceptClients(*reactor);
+          continue;
+        }
+
+        // Check if we're being woken up to stop
+        if (event.data.ptr == &reactor->WakeFd) {
+          uint64_t wake_count;
+          read(reactor->WakeFd, &wake_count, sizeof(wake_count));
+          continue;
+        }
+
+        // Check if there was some operation completed on another socket
+        TcpClient *tcp_client = (TcpClient *)event.data.ptr;
+        reactor->ClientsMutex.lock();
+        if (tcp_client->is_connected_) {
+          bool disconnect_client = (event.events & EPOLLERR) != 0;
+          if (!disconnect_client && (event.events & EPOLLOUT)) {
+            disconnect_client = !flushClient(*tcp_client);
+          }
+          if (!disconnect_client && (event.events & (EPOLLIN | EPOLLRDHUP
+            | EPOLLHUP)) && !tcp_client->is_read_ready_) {
+            bool has_more = false;
+            disconnect_client = !receiveClient(*tcp_client, has_more);
+            if (!disconnect_client && has_more) {
+              queueReady(*reactor, *tcp_client);
+            }
+          }
+          if (disconnect_client) {
+            closeClient(*reactor, *tcp_client);
+            removeClient(*reactor, *tcp_client);
+          }
+        }
+        reactor->ClientsMutex.unlock();
+
+        // Don't let a long pass hold the sends back past the budget
+        if (isSendBudgetSpent(*reactor)) {
+          submitSends(*reactor, pending_sends);
+        }
+      }
+
+      serviceReadyClients(*reactor, ready_clients, pending_sends);
+
+      if (is_sharded_) {
+        receiveForwardedSends(*reactor);
+      }
+
+      // Write everything which was coalesced during the pass
+      submitSends(*reactor, pending_sends);
+    }
+  }
+#else
+  void worker_loop(Reactor *reactor) {
+    fd_set socket_set;
+    fd_set write_socket_set;
+    SOCKET max_socket = 0;
+    currentServer() = this;
+    currentReactor() = reactor;
+    Executor::EnableDeferred();
+    while (is_listening_) {
+      // There's no waking a reactor up here, the sends handed over to it are
+      // picked up once select times out
+      if (is_sharded_) {
+        receiveForwardedSends(*reactor);
+      }
+      Executor::RunDeferred();
+
+      // Clear the socket sets
+      FD_ZERO(&socket_set);
+      FD_ZERO(&write_socket_set);
+
+      // Add the listener to the set
+      FD_SET(reactor->ListenSocket, &socket_set);
+      max_socket = reactor->ListenSocket;
+
+      // Add all clients to the set, and wait for the ones with queued data to
+      // become writable
+      bool has_deferred_frames = false;
+      reactor->ClientsMutex.lock();
+      for (auto &tcp_client : reactor->Clients) {
+        if (tcp_client->is_connected_) {
+          has_deferred_frames |= tcp_client->has_deferred_frames_;
+          FD_SET(tcp_client->client_socket_, &socket_set);
+          if (tcp_client->GetSendQueueSize() > 0) {
+            FD_SET(tcp_client->client_socket_, &write_socket_set);
+          }
+
+          // If the client socket is the largest socket, set it so
+          if (tcp_client->client_socket_ > max_socket) {
+            max_socket = tcp_client->client_socket_;
+          }
+        }
+      }
+      reactor->ClientsMutex.unlock();
+
+      // Check if an activity was completed on any of those sockets, time out
+      // so that data queued in the meantime is picked up. Don't wait if
+      // clients have frames left over from their last turn, or work was
+      // deferred to the next pass
+      timeval timeout;
+      timeout.tv_sec = 0;
+      timeout.tv_usec = has_deferred_frames || Executor::HasDeferred() ? 0
+        : JCHAT_TCP_SELECT_TIMEOUT * 1000;
+      int32_t socket_activity = select(max_socket + 1, &socket_set,
+        &write_socket_set, NULL, &timeout);
+
+      // Ensure select didn't fail
+      if (socket_activity == SOCKET_ERROR && errno == EINTR) {
+        continue;
+      }
+
+      // Check if new connections are awaiting
+      if (FD_ISSET(reactor->ListenSocket, &socket_set)) {
+        acceptClients(*reactor);
+      }
+
+      // Check if there was some operation completed on another socket
+      reactor->ClientsMutex.lock();
+      for (size_t i = 0; i < reactor->Clients.size();) {
+        TcpClient &tcp_client = *reactor->Clients[i];
+        bool disconnect_client = false;
+        if (FD_ISSET(tcp_client.client_socket_, &write_socket_set)) {
+          disconnect_client = !flushClient(tcp_client);
+        }
+        if (!disconnect_client
+          && (FD_ISSET(tcp_client.client_socket_, &socket_set)
+          || tcp_client.has_deferred_frames_)) {
+          bool has_more = false;
+          disconnect_client = !receiveClient(tcp_client, has_more);
+        }
+        if (disconnect_client) {
+          // The last client is moved into this position, so check it next
+          closeClient(*reactor, tcp_client);
+          removeClient(*reactor, tcp_client);
+          continue;
+        }
+        i++;
+      }
+      reactor->ClientsMutex.unlock();
+    }
+  }
+#endif
+
+  // The server and reactor the calling thread runs, if it's a reactor
+  static TcpServer *&currentServer() {
+    static thread_local TcpServer *server = nullptr;
+    return server;
+  }
+
+  static Reactor *&currentReactor() {
+    static thread_local Reactor *reactor = nullptr;
+    return reactor;
+  }
+
+  Reactor *getCurrentReactor() {
+    if (currentServer() != this) {
+      return nullptr;
+    }
+    return currentReactor();
+  }
+
+  // Whether the calling thread is the reactor which owns the client
+  bool isOwner(uint32_t reactor_index) {
+    Reactor *reactor = getCurrentReactor();
+    return reactor != nullptr && reactor->Index == reactor_index;
+  }
+
+  // Copies the chunks into one frame, for sends which have to outlive them
+  static SharedFrame createFrame(const SendChunk *chunks, size_t chunk_count) {
+    auto frame = std::make_shared<std::vector<uint8_t>>();
+    for (size_t i = 0; i < chunk_count; i++) {
+      frame->insert(frame->end(), chunks[i].Data,
+        chunks[i].Data + chunks[i].Size);
+    }
+    return frame;
+  }
+
+  // Hands a send over to the reactor which owns the client, in sharded mode.
+  // Only the handle and a reference to the frame are passed, the owner looks
+  // the client up itself. Fails if the server has stopped
+  bool forwardSend(ConnectionHandle handle, const SharedFrame &frame,
+    SendPriority priority) {
+    RcuReadLock read_lock;
+    Reactor *reactor = findReactor(getReactorIndex(handle));
+    if (reactor == nullptr) {
+      return false;
+    }
+    ShardMessage message = { handle, frame, priority };
+    reactor->Inbox.Push(std::move(message));
+
+    // The reactor clears the flag before it empties its inbox, so it's woken
+    // up again for anything it might have missed
+    if (!reactor->IsInboxWoken.exchange(true, std::memory_order_acq_rel)) {
+      wakeWorker(*reactor);
+    }
+    return true;
+  }
+
+  // Sends what the other threads handed over to the clients of this reactor
+  void receiveForwardedSends(Reactor &reactor) {
+    reactor.IsInboxWoken.exchange(false, std::memory_order_acq_rel);
+    RcuReadLock read_lock;
+    ShardMessage message;
+    while (reactor.Inbox.TryPop(message)) {
+      TcpClient *tcp_client = reactor.Connections.Get(
+        getSlotHandle(message.Handle));
+      if (tcp_client != nullptr) {
+        sendLocal(*tcp_client, message.Frame, message.Priority);
+      }
+    }
+  }
+
+  // Applies the slow consumer policy before size more bytes are queued for a
+  // client, returns false if they mustn't be queued. Control data may go up
+  // to twice the high watermark before the client is disconnected, so a
+  // client's queue never grows past that. NOTE: send_mutex_ must be held
+  bool admitSend(TcpClient &tcp_client, size_t size, SendPriority priority) {
+    if (tcp_client.is_send_shutdown_) {
+      return false;
+    }
+    bool is_droppable = priority == kSendPriority_Bulk;
+
+    size_t queue_size = tcp_client.getSendQueueSize();
+    if (tcp_client.is_fanout_stopped_ && queue_size <= send_low_watermark_) {
+      tcp_client.is_fanout_stopped_ = false;
+    }
+    if (tcp_client.is_fanout_stopped_ && is_droppable) {
+      refused_frames_++;
+      return false;
+    }
+    if (send_high_watermark_ == 0 || queue_size == 0
+      || queue_size + size <= send_high_watermark_) {
+      return true;
+    }
+
+    if (slow_consumer_policy_ == kSlowConsumerPolicy_DropOldest) {
+      dropped_frames_ += tcp_client.dropFrames(send_low_watermark_);
+      queue_size = tcp_client.getSendQueueSize();
+      if (queue_size + size <= send_high_watermark_) {
+        return true;
+      }
+      if (is_droppable) {
+        refused_frames_++;
+        return false;
+      }
+    } else if (slow_consumer_policy_ == kSlowConsumerPolicy_StopFanout) {
+      if (!tcp_client.is_fanout_stopped_) {
+        tcp_client.is_fanout_stopped_ = true;
+        fanout_stops_++;
+      }
+      if (is_droppable) {
+        refused_frames_++;
+        return false;
+      }
+    }
+
+    if (slow_consumer_policy_ != kSlowConsumerPolicy_Disconnect
+      && queue_size + size <= send_high_watermark_ * 2) {
+      return true;
+    }
+
+    // The reactor closes the client once it sees it's shut down
+    tcp_client.is_send_shutdown_ = true;
+    slow_disconnects_++;
+#if defined(OS_WIN)
+    shutdown(tcp_client.client_socket_, SD_BOTH);
+#else
+    shutdown(tcp_client.client_socket_, SHUT_RDWR);
+#endif
+    return false;
+  }
+
+  bool sendLocal(TcpClient &tcp_client, const SendChunk *chunks,
+    size_t chunk_count, SendPriority priority) {
+    std::unique_lock<std::mutex> send_lock = lockShard(tcp_client.send_mutex_);
+    if (!tcp_client.is_internal_ || !tcp_client.is_connected_) {
+      return false;
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < chunk_count; i++) {
+      size += chunks[i].Size;
+    }
+    if (!admitSend(tcp_client, size, priority)) {
+      return false;
+    }
+
+#if defined(OS_LINUX)
+    if (isCoalescing(tcp_client)) {
+      tcp_client.pushFrame(chunks, chunk_count, priority);
+      return scheduleSend(tcp_client);
+    }
+#endif
+    return tcp_client.queueSend(chunks, chunk_count, priority);
+  }
+
+  bool sendLocal(TcpClient &tcp_client, const SharedFrame &frame,
+    SendPriority priority) {
+    std::unique_lock<std::mutex> send_lock = lockShard(tcp_client.send_mutex_);
+    if (!tcp_client.is_internal_ || !tcp_client.is_connected_) {
+      return false;
+    }
+    if (!admitSend(tcp_client, frame->size(), priority)) {
+      return false;
+    }
+
+#if defined(OS_LINUX)
+    if (isCoalescing(tcp_client)) {
+      tcp_client.pushFrame(frame, 0, priority);
+      return scheduleSend(tcp_client);
+    }
+#endif
+    return tcp_client.queueFrame(frame, priority);
+  }
+
+  // Whether the client's sends wait for its reactor to write them, io_uring
+  // clients always do
+  bool isCoalescing(TcpClient &tcp_client) {
+#if defined(JCHAT_IO_URING)
+    if (tcp_client.uses_io_uring_) {
+      return true;
+    }
+#endif
+    return coalesce_budget_ > 0;
+  }
+
+  static void destroyReactor(Reactor *reactor) {
+    closePoller(*reactor);
+    delete reactor;
+  }
+
+  // Destroys reactors which were never published
+  void destroyReactors() {
+    for (auto reactor : reactors_) {
+      destroyReactor(reactor);
+    }
+    reactors_.clear();
+  }
+
+  // Unpublishes the reactors once they've stopped, they're only destroyed
+  // once no other thread can be looking up their clients or forwarding sends
+  // to them anymore
+  void retireReactors() {
+    for (auto reactor : reactors_) {
+      published_reactors_[reactor->Index].store(nullptr,
+        std::memory_order_release);
+      Rcu::Get().Retire([reactor]() {
+        destroyReactor(reactor);
+      });
+    }
+    reactors_.clear();
+  }
+
+public:
+  TcpServer(const char *hostname, uint16_t port, uint32_t reactor_count = 1)
+    : hostname_(hostname), port_(port), is_listening_(false),
+    listen_endpoint_("0.0.0.0", port), reactor_count_(reactor_count),
+    use_io_uring_(false), is_using_io_uring_(false), is_sharded_(false),
+    coalesce_budget_(0), read_budget_(JCHAT_TCP_SERVER_READ_BUDGET),
+    frame_budget_(JCHAT_TCP_SERVER_FRAME_BUDGET),
+    send_low_watermark_(JCHAT_TCP_SERVER_SEND_LOW_WATERMARK),
+    send_high_watermark_(JCHAT_TCP_SERVER_SEND_HIGH_WATERMARK),
+    slow_consumer_policy_(kSlowConsumerPolicy_DropOldest), dropped_frames_(0),
+    refused_frames_(0), fanout_stops_(0), slow_disconnects_(0),
+    denied_connections_(0), backlog_(JCHAT_TCP_SERVER_BACKLOG),
+    defer_accept_timeout_(0), fast_open_queue_size_(0) {
+#if !defined(OS_LINUX)
+    // Only Linux balances connections between listeners sharing a port, so
+    // every other platform uses a single reactor
+    reactor_count_ = 1;
+#endif
+    if (reactor_count_ == 0) {
+      reactor_count_ = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    published_reactors_.reset(new std::atomic<Reactor *>[reactor_count_]);
+    for (uint32_t i = 0; i < reactor_count_; i++) {
+      published_reactors_[i] = nullptr;
+    }
+    reactor_bits_ = 0;
+    while ((1u << reactor_bits_) < reactor_count_) {
+      reactor_bits_++;
+    }
+
+#if defined(OS_WIN)
+    // Initialize Winsock
+    WSAStartup(MAKEWORD(2, 2), &wsa_data_);
+#endif
+
+    // Get remote address info
+    addrinfo *result = nullptr;
+    addrinfo hints;
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    hints.ai_flags = AI_PASSIVE;
+
+    int return_value = getaddrinfo(hostname, std::to_string(port).c_str(),
+      &hints, &result);
+    if (return_value != SOCKET_ERROR) {
+      for (addrinfo *ptr = result; ptr != NULL; ptr = ptr->ai_next) {
+        if (ptr->ai_family == AF_INET) {
+          sockaddr_in *endpoint_info = (sockaddr_in *)ptr->ai_addr;
+          listen_endpoint_.SetAddress(ntohl(endpoint_info->sin_addr.s_addr));
+          break;
+        }
+      }
+    }
+
+     freeaddrinfo(result);
+  }
+
+  ~TcpServer() {
+    if (is_listening_) {
+      is_listening_ = false;
+      for (auto reactor : reactors_) {
+        wakeWorker(*reactor);
+        reactor->WorkerThread.join();
+        closesocket(reactor->ListenSocket);
+      }
+      retireReactors();
+
+#if defined(OS_WIN)
+      // Cleanup Winsock
+      WSACleanup();
+#endif
+    }
+  }
+
+  bool Start() {
+    if (is_listening_) {
+      return false;
+    }
+
+    for (uint32_t i = 0; i < reactor_count_; i++) {
+      Reactor *reactor = new Reactor();
+      reactor->Index = i;
+      reactor->IsInboxWoken = false;
+#if defined(OS_LINUX)
+      reactor->HasPendingSends = false;
+#endif
+      if (!openListener(*reactor)) {
+        delete reactor;
+        for (auto opened_reactor : reactors_) {
+          closesocket(opened_reactor->ListenSocket);
+        }
+        destroyReactors();
+        return false;
+      }
+      reactors_.push_back(reactor);
+      if (!openPoller(*reactor)) {
+        for (auto opened_reactor : reactors_) {
+          closesocket(opened_reactor->ListenSocket);
+        }
+        destroyReactors();
+        return false;
+      }
+    }
+
+    is_listening_ = true;
+#if defined(JCHAT_IO_URING)
+    is_using_io_uring_ = reactors_[0]->Ring != nullptr;
+#endif
+    for (auto reactor : reactors_) {
+      published_reactors_[reactor->Index].store(reactor,
+        std::memory_order_release);
+    }
+    for (auto reactor : reactors_) {
+      reactor->WorkerThread = std::thread(&TcpServer::worker_loop, this,
+        reactor);
+    }
+
+    return true;
+  }
+
+  bool Stop() {
+    if (!is_listening_) {
+      return false;
+    }
+
+    is_listening_ = false;
+    for (auto reactor : reactors_) {
+      wakeWorker(*reactor);
+      reactor->WorkerThread.join();
+      closesocket(reactor->ListenSocket);
+    }
+
+    // Disconnect the remaining clients
+    for (auto reactor : reactors_) {
+      reactor->ClientsMutex.lock();
+      for (auto &tcp_client : reactor->Clients) {
+        closeClient(*reactor, *tcp_client);
+      }
+      reactor->Clients.clear();
+      reactor->ClientsMutex.unlock();
+    }
+
+    retireReactors();
+
+    return true;
+  }
+
+  // Disconnects a client, this is safe to call from any thread. The client is
+  // shut down here and closed by the reactor that owns it
+  bool DisconnectClient(TcpClient &tcp_client) {
+    tcp_client.send_mutex_.lock();
+    if (!tcp_client.is_internal_ || !tcp_client.is_connected_) {
+      tcp_client.send_mutex_.unlock();
+      return false;
+    }
+#if defined(OS_WIN)
+    shutdown(tcp_client.client_socket_, SD_BOTH);
+#else
+    shutdown(tcp_client.client_socket_, SHUT_RDWR);
+#endif
+    tcp_client.send_mutex_.unlock();
+    return true;
+  }
+
+  // Looks up a connected client by its handle, this is safe to call from any
+  // thread. Fails if the client has disconnected since the handle was taken
+  bool GetClient(ConnectionHandle handle,
+    std::shared_ptr<TcpClient> &out_client) {
+    RcuReadLock read_lock;
+    TcpClient *tcp_client = findClient(handle);
+    if (tcp_client == nullptr) {
+      return false;
+    }
+    out_client = tcp_client->shared_from_this();
+    return true;
+  }
+
+  bool DisconnectClient(ConnectionHandle handle) {
+    std::shared_ptr<TcpClient> tcp_client;
+    if (!GetClient(handle, tcp_client)) {
+      return false;
+    }
+    return DisconnectClient(*tcp_client);
+  }
+
+  // Sends data to a client, this is safe to call from any thread including
+  // reactors which don't own the client. Whatever the socket can't take right
+  // away is queued and sent by the reactor once the socket is writable, use
+  // TcpClient::GetSendQueueSize to check how far behind a client is
+  bool Send(TcpClient &tcp_client, Buffer &buffer) {
+    SendChunk chunk = { buffer.GetBuffer(), buffer.GetSize() };
+    return Send(tcp_client, &chunk, 1);
+  }
+
+  // Sends the chunks to a client as if they were a single buffer, see
+  // TcpClient::Send. Control data is sent before any bulk data which is still
+  // queued for the client
+  bool Send(TcpClient &tcp_client, const SendChunk *chunks,
+    size_t chunk_count, SendPriority priority = kSendPriority_Control) {
+    // In sharded mode only the reactor which owns a client sends to it, every
+    // other thread hands the data over to the owner. The chunks don't outlive
+    // the call, so they're copied into a frame for that, send a SharedFrame
+    // to avoid it
+    if (is_sharded_ && !isOwner(tcp_client.reactor_index_)) {
+      return forwardSend(tcp_client.handle_, createFrame(chunks, chunk_count),
+        priority);
+    }
+    return sendLocal(tcp_client, chunks, chunk_count, priority);
+  }
+
+  // Sends to a client by its handle, which fails if the client is gone. This
+  // doesn't take a reference to the client, and in sharded mode the handle is
+  // all that's handed over to the owner
+  bool Send(ConnectionHandle handle, const SendChunk *chunks,
+    size_t chunk_count, SendPriority priority = kSendPriority_Control) {
+    if (is_sharded_ && !isOwner(getReactorIndex(handle))) {
+      return forwardSend(handle, createFrame(chunks, chunk_count), priority);
+    }
+    RcuReadLock read_lock;
+    TcpClient *tcp_client = findClient(handle);
+    return tcp_client != nullptr
+      && sendLocal(*tcp_client, chunks, chunk_count, priority);
+  }
+
+  // Sends a shared frame to a client, whatever the socket can't take is queued
+  // by reference instead of being copied
+  bool Send(TcpClient &tcp_client, const SharedFrame &frame,
+    SendPriority priority = kSendPriority_Control) {
+    if (is_sharded_ && !isOwner(tcp_client.reactor_index_)) {
+      return forwardSend(tcp_client.handle_, frame, priority);
+    }
+    return sendLocal(tcp_client, frame, priority);
+  }
+
+  bool Send(ConnectionHandle handle, const SharedFrame &frame,
+    SendPriority priority = kSendPriority_Control) {
+    if (is_sharded_ && !isOwner(getReactorIndex(handle))) {
+      return forwardSend(handle, frame, priority);
+    }
+    RcuReadLock read_lock;
+    TcpClient *tcp_client = findClient(handle);
+    return tcp_client != nullptr && sendLocal(*tcp_client, frame, priority);
+  }
+
+  // Sends the same frame to every client in the list except skip_handle,
+  // skipping the ones which have disconnected. Returns the number of clients
+  // it was sent to, in sharded mode that counts the sends handed over to
+  // other reactors
+  size_t Broadcast(const ConnectionHandle *handles, size_t handle_count,
+    const SharedFrame &frame, ConnectionHandle skip_handle
+    = ConnectionHandle(), SendPriority priority = kSendPriority_Control) {
+    // The clients stay alive until the read section ends, so they're sent to
+    // straight from the tables without taking a reference to each
+    RcuReadLock read_lock;
+    size_t sent_count = 0;
+    for (size_t i = 0; i < handle_count; i++) {
+      if (handles[i] == skip_handle) {
+        continue;
+      }
+      if (Send(handles[i], frame, priority)) {
+        sent_count++;
+      }
+    }
+    return sent_count;
+  }
+
+  // Returns the number of connected clients
+  size_t GetClientCount() {
+    RcuReadLock read_lock;
+    size_t client_count = 0;
+    for (uint32_t i = 0; i < reactor_count_; i++) {
+      Reactor *reactor = findReactor(i);
+      if (reactor != nullptr) {
+        client_count += reactor->Connections.GetSize();
+      }
+    }
+    return client_count;
+  }
+
+  IPEndpoint GetListenEndpoint() {
+    return listen_endpoint_;
+  }
+
+  uint32_t GetReactorCount() {
+    return reactor_count_;
+  }
+
+  // Asks for the reactors to run on io_uring instead of epoll, this only takes
+  // effect if it's called before Start and the kernel supports io_uring.
+  // Otherwise the server keeps using epoll (or select)
+  bool SetUseIoUring(bool use_io_uring) {
+    if (is_listening_) {
+      return false;
+    }
+    use_io_uring_ = use_io_uring;
+    return true;
+  }
+
+  bool IsUsingIoUring() {
+    return is_using_io_uring_;
+  }
+
+  // Makes every reactor a shard which is the only thread that sends to its
+  // clients. Data any other thread (another reactor, or an executor worker)
+  // sends to a client is passed to the owner through its lock-free inbox, so
+  // a client's send queue is only ever touched by its reactor and is used
+  // without locking. This only takes effect if it's called before Start
+  bool SetSharded(bool is_sharded) {
+    if (is_listening_) {
+      return false;
+    }
+    is_sharded_ = is_sharded;
+    return true;
+  }
+
+  bool IsSharded() {
+    return is_sharded_;
+  }
+
+  // Holds the data sent to a client until the end of its reactor's pass, so
+  // that everything sent to it in the meantime is written with one call
+  // instead of one call (and often one packet) per send. The budget, in
+  // microseconds, caps how long the data may wait when a pass runs long, 0
+  // sends straight away. io_uring reactors always batch their sends per pass
+  // and only use the budget as the cap. Linux only, this only takes effect if
+  // it's called before Start
+  bool SetCoalesceBudget(uint32_t coalesce_budget) {
+    if (is_listening_) {
+      return false;
+    }
+    coalesce_budget_ = coalesce_budget;
+    return true;
+  }
+
+  uint32_t GetCoalesceBudget() {
+    return coalesce_budget_;
+  }
+
+  // Sets how much each client may read (in bytes) and how many frames its
+  // handler may dispatch (see TcpClient::TakeFrameBudget) in one turn. A
+  // client which uses up its turn with data left over goes to the back of its
+  // reactor's ready list, and the other ready clients take their turns before
+  // it gets another, so one client flooding the server can't hold the others
+  // up. 0 lifts the limit. This only takes effect if it's called before Start
+  bool SetReadBudget(size_t read_budget, uint32_t frame_budget) {
+    if (is_listening_) {
+      return false;
+    }
+    read_budget_ = read_budget;
+    frame_budget_ = frame_budget;
+    return true;
+  }
+
+  size_t GetReadBudget() {
+    return read_budget_;
+  }
+
+  uint32_t GetFrameBudget() {
+    return frame_budget_;
+  }
+
+  // Sets how much data may be queued for a client (in bytes) before the slow
+  // consumer policy steps in, and how far it has to drain before the policy
+  // lets go of it. A high watermark of 0 lets queues grow without bound
+  bool SetSendWatermarks(size_t low_watermark, size_t high_watermark) {
+    if (is_listening_ || low_watermark > high_watermark) {
+      return false;
+    }
+    send_low_watermark_ = low_watermark;
+    send_high_watermark_ = high_watermark;
+    return true;
+  }
+
+  bool SetSlowConsumerPolicy(SlowConsumerPolicy slow_consumer_policy) {
+    if (is_listening_) {
+      return false;
+    }
+    slow_consumer_policy_ = slow_consumer_policy;
+    return true;
+  }
+
+  SlowConsumerPolicy GetSlowConsumerPolicy() {
+    return slow_consumer_policy_;
+  }
+
+  SlowConsumerCounters GetSlowConsumerCounters() {
+    SlowConsumerCounters counters;
+    counters.DroppedFrames = dropped_frames_;
+    counters.RefusedFrames = refused_frames_;
+    counters.FanoutStops = fanout_stops_;
+    counters.Disconnects = slow_disconnects_;
+    return counters;
+  }
+
+  // The deny list checked as connections are accepted. It can be changed or
+  // reloaded at any time, accepting carries on with the old list until the
+  // new one is published
+  IpFilter &GetIpFilter() {
+    return ip_filter_;
+  }
+
+  // How many connections the deny list has turned away
+  uint64_t GetDeniedConnections() {
+    return denied_connections_;
+  }
+
+  // Sets the length of the queue of connections waiting to be accepted, the
+  // system may cap it. NOTE: Listener options only apply if they're set before
+  // Start
+  bool SetBacklog(int32_t backlog) {
+    if (is_listening_ || backlog <= 0) {
+      return false;
+    }
+    backlog_ = backlog;
+    return true;
+  }
+
+  // Only wake us up for a new connection once the client has sent something,
+  // or the timeout (in seconds) expired. 0 disables it. Linux only
+  bool SetDeferAccept(int32_t timeout) {
+    if (is_listening_ || timeout < 0) {
+      return false;
+    }
+    defer_accept_timeout_ = timeout;
+    return true;
+  }
+
+  // Allows clients which connected before to send data along with their SYN,
+  // queue_size limits the connections which haven't finished their handshake
+  // yet. 0 disables it
+  bool SetFastOpen(int32_t queue_size) {
+    if (is_listening_ || queue_size < 0) {
+      return false;
+    }
+    fast_open_queue_size_ = queue_size;
+    return true;
+  }
+
+  Event<TcpClient &> OnClientConnected;
+  Event<TcpClient &> OnClientDisconnected;
+
+  // NOTE: The buffer holds all the data received from the client that hasn't
+  // been consumed yet, starting at the buffer position. Handlers should leave
+  // the buffer position after the last byte they consumed, anything after it
+  // is kept for the next call
+  Event<TcpClient &, Buffer &> OnDataReceived;
+};
+}
+
+#endif // jchat_lib_tcp_server_hpp_
@@ -0,0 +1,101 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_lib_token_bucket_hpp_
+#define jchat_lib_token_bucket_hpp_
+
+// Required libraries
+#include <chrono>
+#include <algorithm>
+#include <stdint.h>
+
+namespace jchat {
+// How much may be taken per second, and how much may be taken at once after
+// a quiet period. A rate of 0 lifts the limit
+struct RateLimit {
+  uint32_t Rate;
+  uint32_t Burst;
+};
+
+// Tokens refill at the limit's rate up to its burst, and whatever is taken
+// has to be covered by them. The bucket starts full. NOTE: This isn't thread
+// safe, keep a bucket per thread or guard it
+// Example:
+//    RateLimit limit = { 10, 20 }; // 10 per second, 20 at once
+//    TokenBucket bucket;
+//    if (!bucket.Take(limit, 1, TokenBucket::Now())) { ... }
+class TokenBucket {
+  double tokens_;
+  uint64_t last_time_; // 0 until the bucket is first used
+
+  void refill(const RateLimit &limit, uint64_t now) {
+    if (last_time_ == 0) {
+      tokens_ = limit.Burst;
+    } else if (now > last_time_) {
+      tokens_ = std::min<double>(limit.Burst, tokens_
+        + (now - last_time_) * (limit.Rate / 1000000000.0));
+    }
+    last_time_ = now;
+  }
+
+public:
+  TokenBucket() : tokens_(0), last_time_(0) {
+  }
+
+  // The current time in nanoseconds, taken once per check so that several
+  // buckets can share it
+  static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // Returns true if the tokens can be taken right now, without taking them
+  bool CanTake(const RateLimit &limit, uint64_t count, uint64_t now) {
+    if (limit.Rate == 0) {
+      return true;
+    }
+    refill(limit, now);
+    return tokens_ >= count;
+  }
+
+  // Takes the tokens if there are enough of them, returns false otherwise
+  bool Take(const RateLimit &limit, uint64_t count, uint64_t now) {
+    if (!CanTake(limit, count, now)) {
+      return false;
+    }
+    if (limit.Rate != 0) {
+      tokens_ -= count;
+    }
+    return true;
+  }
+};
+
+// Limits messages and the bytes they carry together
+struct TrafficLimit {
+  RateLimit Messages; // Messages per second
+  RateLimit Bytes; // Bytes per second
+};
+
+struct TrafficBucket {
+  TokenBucket Messages;
+  TokenBucket Bytes;
+
+  // Takes a message of the size, or nothing if either bucket is short
+  bool Take(const TrafficLimit &limit, uint64_t size, uint64_t now) {
+    if (!Messages.CanTake(limit.Messages, 1, now)
+      || !Bytes.CanTake(limit.Bytes, size, now)) {
+      return false;
+    }
+    Messages.Take(limit.Messages, 1, now);
+    Bytes.Take(limit.Bytes, size, now);
+    return true;
+  }
+};
+}
+
+#endif // jchat_lib_token_bucket_hpp_
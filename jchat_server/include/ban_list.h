@@ -0,0 +1,70 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_server_ban_list_h_
+#define jchat_server_ban_list_h_
+
+#include "flat_map.hpp"
+#include <unordered_set>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace jchat {
+// A channel's bans, each a username@hostname mask where * matches any run of
+// characters and ? matches any one. Masks are compared case folded. Exact
+// masks are kept in a hash set, and wildcard masks are indexed in a trie by
+// their literal prefix or, reversed, by their literal suffix, whichever is
+// longer. A check only runs the masks whose anchor the subject starts or ends
+// with, plus the few with no anchor at all. NOTE: This isn't thread safe, the
+// channel's mailbox owns it
+// Example:
+//    BanList bans;
+//    bans.Add("spam*@*");
+//    bans.IsBanned("spammer", "1f2e3d"); // true
+class BanList {
+  struct Node {
+    FlatMap<char, uint32_t> Children;
+    std::vector<uint32_t> Masks; // Masks whose anchor ends at this node
+  };
+
+  std::vector<std::string> bans_; // As they were added
+  std::unordered_set<std::string> folded_bans_; // Every mask, case folded
+  std::vector<std::string> wildcard_masks_; // Case folded
+  std::vector<Node> prefix_nodes_;
+  std::vector<Node> suffix_nodes_;
+  std::vector<uint32_t> unanchored_masks_;
+
+  static void addToTrie(std::vector<Node> &nodes, const std::string &anchor,
+    uint32_t mask_index);
+  static bool isMatch(const std::string &mask, const std::string &subject);
+  bool matchTrie(std::vector<Node> &nodes, const std::string &subject,
+    bool is_reversed);
+
+public:
+  BanList();
+
+  // Returns true if the text has * or ? in it
+  static bool IsWildcard(const std::string &mask);
+  // Returns true if username@hostname equals or matches the mask
+  static bool IsMatch(const std::string &mask, const std::string &username,
+    const std::string &hostname);
+
+  // Adds the mask, returns false if it's already in the list
+  bool Add(const std::string &mask);
+  bool Contains(const std::string &mask) const;
+
+  // Returns true if username@hostname equals or matches any of the masks
+  bool IsBanned(const std::string &username, const std::string &hostname);
+
+  const std::vector<std::string> &GetBans() const;
+  size_t GetSize() const;
+};
+}
+
+#endif // jchat_server_ban_list_h_
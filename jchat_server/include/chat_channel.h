@@ -1,30 +1,73 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#ifndef jchat_server_chat_channel_h_
-#define jchat_server_chat_channel_h_
-
-#include "remote_chat_client.h"
-#include "chat_user.h"
-#include <map>
-#include <memory>
-
-namespace jchat {
-struct ChatChannel {
-  bool Enabled;
-  std::string Name;
-  std::map<RemoteChatClient *, std::shared_ptr<ChatUser>> Operators;
-  std::mutex OperatorsMutex;
-  std::map<RemoteChatClient *, std::shared_ptr<ChatUser>> Clients;
-  std::mutex ClientsMutex;
-  std::vector<std::string> BannedUsers; // Format: username@hostname
-  std::mutex BannedUsersMutex;
-};
-}
-
-#endif // jchat_server_chat_channel_h_
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_server_chat_channel_h_
+#define jchat_server_chat_channel_h_
+
+#include "remote_chat_client.h"
+#include "chat_user.h"
+#include "tcp_client.hpp"
+#include "executor.hpp"
+#include "flat_map.hpp"
+#include "rcu.hpp"
+#include "token_bucket.hpp"
+#include "ban_list.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace jchat {
+struct ChatChannel;
+
+// The channels a client is in, kept in the channel component's state slot so
+// that a disconnect only visits those. Channel mailboxes add and remove
+// themselves under the mutex
+struct ChannelMemberships {
+  std::mutex Mutex;
+  bool Closed; // Set when the client disconnects, nothing may join after
+  uint32_t PendingJoins; // Joins posted to a mailbox which haven't finished
+  std::vector<std::shared_ptr<ChatChannel>> Channels;
+
+  ChannelMemberships() : Closed(false), PendingJoins(0) {
+  }
+};
+
+// The client a case folded username finds in a channel. A client which
+// reconnects under the same name can join before its old connection is
+// removed, Count keeps track of such clients so that the name stays with one
+// of them until the last leaves
+struct ChannelMember {
+  ConnectionHandle Handle;
+  uint32_t Count; // Clients in the channel with the name
+};
+
+// A channel is an actor, everything which reads or changes its members is
+// posted to its mailbox and runs one at a time, so the channel needs no locks.
+// Members are keyed by their connection handle, which stays unique even after
+// the client is gone
+struct ChatChannel {
+  bool Enabled; // Set to false by the mailbox when the channel is closed
+  std::string Name;
+  std::shared_ptr<Strand> Mailbox;
+  FlatMap<ConnectionHandle, std::shared_ptr<ChatUser>> Operators;
+  FlatMap<ConnectionHandle, std::shared_ptr<ChatUser>> Clients;
+  FlatMap<ConnectionHandle, std::shared_ptr<ChannelMemberships>>
+    Memberships; // Same as Clients
+  std::unordered_map<std::string, ChannelMember> Members; // By username
+  BanList BannedUsers; // Format: username@hostname, masks may use * and ?
+  TrafficBucket Traffic; // The channel's share of the rate limit
+
+  // The handles of every client, rebuilt by the mailbox whenever Clients
+  // changes. Broadcasts walk this instead of Clients, and it can be read from
+  // any thread
+  RcuPointer<std::vector<ConnectionHandle>> Recipients;
+};
+}
+
+#endif // jchat_server_chat_channel_h_
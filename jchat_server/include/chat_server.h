@@ -1,75 +1,133 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#ifndef jchat_server_chat_server_h_
-#define jchat_server_chat_server_h_
-
-// Required libraries
-#include "tcp_server.hpp"
-#include "remote_chat_client.h"
-#include "chat_component.h"
-#include "protocol/protocol.h"
-#include "protocol/component_type.h"
-#include <map>
-
-namespace jchat {
-class ChatServer {
-  bool is_listening_;
-  TcpServer tcp_server_;
-  bool is_little_endian_;
-  std::vector<std::shared_ptr<ChatComponent>> components_;
-  std::map<TcpClient *, RemoteChatClient *> clients_;
-  std::mutex clients_mutex_;
-
-  // Internal events
-  bool onClientConnected(TcpClient &tcp_client);
-  bool onClientDisconnected(TcpClient &tcp_client);
-  bool onDataReceived(TcpClient &tcp_client, Buffer &buffer);
-
-  // Internal functions
-  bool getTcpClient(RemoteChatClient &client, TcpClient **out_client);
-
-  // Send functions
-  bool send(TcpClient &client, ComponentType component_type,
-    uint8_t message_type, TypedBuffer &buffer);
-  bool send(TcpClient *client, ComponentType component_type,
-    uint8_t message_type, TypedBuffer &buffer);
-
-public:
-  ChatServer(const char *hostname, uint16_t port);
-  ~ChatServer();
-
-  bool Start();
-  bool Stop();
-
-  bool AddComponent(std::shared_ptr<ChatComponent> component);
-  bool RemoveComponent(std::shared_ptr<ChatComponent> component);
-
-  bool GetComponent(ComponentType component_type,
-    std::shared_ptr<ChatComponent> &out_component);
-  template<typename _TComponent>
-  bool GetComponent(ComponentType component_type,
-    std::shared_ptr<_TComponent> &out_component) {
-     return GetComponent(component_type,
-       reinterpret_cast<std::shared_ptr<ChatComponent> &>(out_component));
-  }
-
-  TypedBuffer CreateBuffer();
-  bool Send(RemoteChatClient &client, ComponentType component_type,
-    uint8_t message_type, TypedBuffer &buffer);
-  bool Send(RemoteChatClient *client, ComponentType component_type,
-    uint8_t message_type, TypedBuffer &buffer);
-
-  IPEndpoint GetListenEndpoint();
-
-  Event<RemoteChatClient &> OnClientConnected;
-  Event<RemoteChatClient &> OnClientDisconnected;
-};
-}
-
-#endif // jchat_server_chat_server_h_
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_server_chat_server_h_
+#define jchat_server_chat_server_h_
+
+// Required libraries
+#include "tcp_server.hpp"
+#include "executor.hpp"
+#include "remote_chat_client.h"
+#include "chat_component.h"
+#include "rate_limiter.h"
+#include "protocol/protocol.h"
+#include "protocol/component_type.h"
+#include <vector>
+#include <memory>
+
+namespace jchat {
+class ChatServer {
+  bool is_listening_;
+  TcpServer tcp_server_;
+  bool is_little_endian_;
+  std::vector<std::shared_ptr<ChatComponent>> components_;
+  // The number of state slots every client gets, enough for the component
+  // with the highest type
+  size_t state_count_;
+  // Clients indexed by their connection handle's index
+  std::vector<RemoteChatClient *> clients_;
+  std::mutex clients_mutex_;
+
+  // When there are workers the components run on them instead of on the
+  // reactors, each client's messages are kept in order by its strand which is
+  // indexed the same as clients_
+  Executor executor_;
+  uint32_t worker_count_;
+  std::vector<std::shared_ptr<Strand>> strands_;
+
+  RateLimiter rate_limiter_;
+
+  // Internal events
+  bool onClientConnected(TcpClient &tcp_client);
+  bool onClientDisconnected(TcpClient &tcp_client);
+  bool onDataReceived(TcpClient &tcp_client, Buffer &buffer);
+
+  // Internal functions
+  RemoteChatClient *getChatClient(ConnectionHandle handle,
+    std::shared_ptr<Strand> *out_strand = nullptr);
+  void connectClient(RemoteChatClient *chat_client);
+  void disconnectClient(RemoteChatClient *chat_client);
+  bool handleMessage(RemoteChatClient &chat_client, uint8_t component_type,
+    uint16_t message_type, TypedBuffer &buffer);
+  bool getTcpClient(RemoteChatClient &client,
+    std::shared_ptr<TcpClient> &out_client);
+
+  // Send functions
+  bool send(ConnectionHandle handle, ComponentType component_type,
+    uint8_t message_type, TypedBuffer &buffer, SendPriority priority);
+  SharedFrame createFrame(ComponentType component_type, uint8_t message_type,
+    TypedBuffer &buffer);
+
+public:
+  ChatServer(const char *hostname, uint16_t port, uint32_t thread_count = 1);
+  ~ChatServer();
+
+  bool Start();
+  bool Stop();
+
+  bool AddComponent(std::shared_ptr<ChatComponent> component);
+  bool RemoveComponent(std::shared_ptr<ChatComponent> component);
+
+  bool GetComponent(ComponentType component_type,
+    std::shared_ptr<ChatComponent> &out_component);
+  template<typename _TComponent>
+  bool GetComponent(ComponentType component_type,
+    std::shared_ptr<_TComponent> &out_component) {
+     return GetComponent(component_type,
+       reinterpret_cast<std::shared_ptr<ChatComponent> &>(out_component));
+  }
+
+  TypedBuffer CreateBuffer();
+  // Replies, acknowledgements and moderation are control messages, which are
+  // sent ahead of any bulk messages (chat) still queued for the client
+  bool Send(RemoteChatClient &client, ComponentType component_type,
+    uint8_t message_type, TypedBuffer &buffer,
+    SendPriority priority = kSendPriority_Control);
+  bool Send(RemoteChatClient *client, ComponentType component_type,
+    uint8_t message_type, TypedBuffer &buffer,
+    SendPriority priority = kSendPriority_Control);
+  // Sends to a client by its handle, this fails if the client is gone
+  bool Send(ConnectionHandle handle, ComponentType component_type,
+    uint8_t message_type, TypedBuffer &buffer,
+    SendPriority priority = kSendPriority_Control);
+  // Sends the same message to every client in the list except skip_handle.
+  // The message is encoded once and shared by all of them, returns the number
+  // of clients it was sent to
+  size_t Broadcast(const std::vector<ConnectionHandle> &handles,
+    ComponentType component_type, uint8_t message_type, TypedBuffer &buffer,
+    ConnectionHandle skip_handle = ConnectionHandle(),
+    SendPriority priority = kSendPriority_Control);
+
+  // Returns the amount of data queued for a client which its socket hasn't
+  // taken yet
+  size_t GetSendQueueSize(RemoteChatClient &client);
+
+  // The limits on the chat messages clients send, configure it before
+  // starting
+  RateLimiter &GetRateLimiter();
+
+  IPEndpoint GetListenEndpoint();
+
+  // Gives access to the transport, used to configure it before starting
+  TcpServer &GetTcpServer();
+
+  // Sets the number of threads the components run on, with 0 they run on the
+  // reactor threads. This can only be changed while the server isn't started
+  bool SetWorkerCount(uint32_t worker_count);
+  uint32_t GetWorkerCount();
+
+  // The executor the component handlers run on, components can give it their
+  // own strands. Without workers a strand runs on the thread posting to it
+  Executor &GetExecutor();
+
+  Event<RemoteChatClient &> OnClientConnected;
+  Event<RemoteChatClient &> OnClientDisconnected;
+};
+}
+
+#endif // jchat_server_chat_server_h_
@@ -1,76 +1,137 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#ifndef jchat_server_channel_component_h_
-#define jchat_server_channel_component_h_
-
-#include "chat_component.h"
-#include "chat_channel.h"
-#include "protocol/components/channel_message_result.h"
-#include "event.hpp"
-
-namespace jchat {
-class ChannelComponent : public ChatComponent {
-private:
-  ChatServer *server_;
-  std::vector<std::shared_ptr<ChatChannel>> channels_;
-  std::mutex channels_mutex_;
-
-public:
-  ChannelComponent();
-  ~ChannelComponent();
-
-  // Internal functions
-  virtual bool Initialize(ChatServer &server) override;
-  virtual bool Shutdown() override;
-
-  virtual bool OnStart() override;
-  virtual bool OnStop() override;
-
-  // Internal events
-  virtual void OnClientConnected(RemoteChatClient &client) override;
-  virtual void OnClientDisconnected(RemoteChatClient &client) override;
-
-  // Handler functions
-  virtual ComponentType GetType() override;
-  virtual bool Handle(RemoteChatClient &client, uint16_t message_type,
-    TypedBuffer &buffer) override;
-
-  // API functions
-
-
-  // API events
-  // NOTE: The last argument in these (ChatUser &) is always the source user
-  Event<ChannelMessageResult, std::string &, ChatUser &> OnJoinCompleted;
-  Event<ChannelMessageResult, std::string &, ChatUser &> OnLeaveCompleted;
-  Event<ChannelMessageResult, std::string &, std::string &,
-    ChatUser &> OnSendMessageCompleted;
-  Event<ChannelMessageResult, std::string &, std::string &,
-    ChatUser &> OnOpUserCompleted;
-  Event<ChannelMessageResult, std::string &, std::string &,
-    ChatUser &> OnDeopUserCompleted;
-  Event<ChannelMessageResult, std::string &, std::string &,
-    ChatUser &> OnKickUserCompleted;
-  Event<ChannelMessageResult, std::string &, std::string &,
-    ChatUser &> OnBanUserCompleted;
-  Event<ChannelMessageResult, std::string &, std::string &,
-    ChatUser &> OnUnbanUserCompleted;
-
-  Event<ChatChannel &> OnChannelCreated;
-  Event<ChatChannel &, ChatUser &> OnChannelJoined;
-  Event<ChatChannel &, ChatUser &> OnChannelLeft;
-  Event<ChatChannel &, ChatUser &, std::string &> OnChannelMessage;
-  Event<ChatChannel &, ChatUser &> OnChannelUserOpped;
-  Event<ChatChannel &, ChatUser &> OnChannelUserDeopped;
-  Event<ChatChannel &, ChatUser &> OnChannelUserKicked;
-  Event<ChatChannel &, ChatUser &> OnChannelUserBanned;
-  Event<ChatChannel &, std::string &, std::string &> OnChannelUserUnbanned;
-};
-}
-
-#endif // jchat_server_channel_component_h_
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_server_channel_component_h_
+#define jchat_server_channel_component_h_
+
+#include "chat_component.h"
+#include "chat_channel.h"
+#include "protocol/components/channel_message_result.h"
+#include "event.hpp"
+#include "rcu.hpp"
+#include <unordered_map>
+
+#ifndef JCHAT_CHANNEL_INDEX_SHARDS
+#define JCHAT_CHANNEL_INDEX_SHARDS 64
+#endif // JCHAT_CHANNEL_INDEX_SHARDS
+
+namespace jchat {
+class ChannelComponent : public ChatComponent {
+private:
+  ChatServer *server_;
+  typedef std::unordered_map<std::string,
+    std::shared_ptr<ChatChannel>> ChannelMap;
+
+  // Every open channel by its name, spread over shards by the name's hash.
+  // Lookups read the current snapshot of a shard without locking, creating
+  // and closing a channel publish a new one. A closed channel is erased, and
+  // freed once the last mailbox task and reader holding it are done
+  RcuPointer<ChannelMap> channels_[JCHAT_CHANNEL_INDEX_SHARDS];
+
+  // Registry functions
+  RcuPointer<ChannelMap> &getChannels(const std::string &channel_name);
+  void clearChannels();
+  bool getChannel(const std::string &channel_name,
+    std::shared_ptr<ChatChannel> &out_channel);
+  std::shared_ptr<ChatChannel> getOrCreateChannel(
+    const std::string &channel_name);
+  void disableChannel(ChatChannel &channel);
+
+  // Counts a join the client posted, until the mailbox finishes it
+  void beginJoin(ChannelMemberships &memberships);
+  void endJoin(ChannelMemberships &memberships);
+  // Returns true if the client is in the channel or may be by the time its
+  // mailbox gets to a message posted now
+  bool mayBeInChannel(ChannelMemberships &memberships,
+    const std::shared_ptr<ChatChannel> &channel);
+  // Adds the client to the channel and the channel to the client's
+  // memberships, returns false if the client has already disconnected. Either
+  // way this ends the client's join
+  bool addChannelClient(std::shared_ptr<ChatChannel> channel,
+    ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user,
+    std::shared_ptr<ChannelMemberships> memberships);
+  // Undoes addChannelClient, and takes away operator status
+  void eraseChannelClient(std::shared_ptr<ChatChannel> channel,
+    ConnectionHandle handle);
+  // Rebuilds the channel's recipients after its clients changed
+  void publishRecipients(ChatChannel &channel);
+  // Sends to every client in the channel except skip_handle
+  void broadcast(ChatChannel &channel, ConnectionHandle skip_handle,
+    uint8_t message_type, TypedBuffer &buffer, SendPriority priority);
+
+  // Channel actor functions, these only run from the channel's mailbox
+  void joinChannel(std::shared_ptr<ChatChannel> channel,
+    ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user,
+    std::shared_ptr<ChannelMemberships> memberships);
+  void leaveChannel(std::shared_ptr<ChatChannel> channel,
+    ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user);
+  void sendChannelMessage(std::shared_ptr<ChatChannel> channel,
+    ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user,
+    std::string message);
+  void kickChannelUser(std::shared_ptr<ChatChannel> channel,
+    ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user,
+    std::string target);
+  void banChannelUser(std::shared_ptr<ChatChannel> channel,
+    ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user,
+    std::string target);
+  void removeChannelClient(std::shared_ptr<ChatChannel> channel,
+    ConnectionHandle handle);
+
+public:
+  ChannelComponent();
+  ~ChannelComponent();
+
+  // Internal functions
+  virtual bool Initialize(ChatServer &server) override;
+  virtual bool Shutdown() override;
+
+  virtual bool OnStart() override;
+  virtual bool OnStop() override;
+
+  // Internal events
+  virtual void OnClientConnected(RemoteChatClient &client) override;
+  virtual void OnClientDisconnected(RemoteChatClient &client) override;
+
+  // Handler functions
+  virtual ComponentType GetType() override;
+  virtual bool Handle(RemoteChatClient &client, uint16_t message_type,
+    TypedBuffer &buffer) override;
+
+  // API functions
+
+
+  // API events
+  // NOTE: The last argument in these (ChatUser &) is always the source user
+  Event<ChannelMessageResult, std::string &, ChatUser &> OnJoinCompleted;
+  Event<ChannelMessageResult, std::string &, ChatUser &> OnLeaveCompleted;
+  Event<ChannelMessageResult, std::string &, std::string &,
+    ChatUser &> OnSendMessageCompleted;
+  Event<ChannelMessageResult, std::string &, std::string &,
+    ChatUser &> OnOpUserCompleted;
+  Event<ChannelMessageResult, std::string &, std::string &,
+    ChatUser &> OnDeopUserCompleted;
+  Event<ChannelMessageResult, std::string &, std::string &,
+    ChatUser &> OnKickUserCompleted;
+  Event<ChannelMessageResult, std::string &, std::string &,
+    ChatUser &> OnBanUserCompleted;
+  Event<ChannelMessageResult, std::string &, std::string &,
+    ChatUser &> OnUnbanUserCompleted;
+
+  Event<ChatChannel &> OnChannelCreated;
+  Event<ChatChannel &, ChatUser &> OnChannelJoined;
+  Event<ChatChannel &, ChatUser &> OnChannelLeft;
+  Event<ChatChannel &, ChatUser &, std::string &> OnChannelMessage;
+  Event<ChatChannel &, ChatUser &> OnChannelUserOpped;
+  Event<ChatChannel &, ChatUser &> OnChannelUserDeopped;
+  Event<ChatChannel &, ChatUser &> OnChannelUserKicked;
+  Event<ChatChannel &, ChatUser &> OnChannelUserBanned;
+  Event<ChatChannel &, std::string &, std::string &> OnChannelUserUnbanned;
+};
+}
+
+#endif // jchat_server_channel_component_h_
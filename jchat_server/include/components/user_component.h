@@ -1,60 +1,79 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#ifndef jchat_server_user_component_h_
-#define jchat_server_user_component_h_
-
-#include "chat_component.h"
-#include "chat_user.h"
-#include "protocol/components/user_message_result.h"
-#include "event.hpp"
-#include <map>
-#include <memory>
-
-namespace jchat {
-class UserComponent : public ChatComponent {
-private:
-  ChatServer *server_;
-  std::map<RemoteChatClient *, std::shared_ptr<ChatUser>> users_;
-  std::mutex users_mutex_;
-
-public:
-  UserComponent();
-  ~UserComponent();
-
-  // Internal functions
-  virtual bool Initialize(ChatServer &server) override;
-  virtual bool Shutdown() override;
-
-  virtual bool OnStart() override;
-  virtual bool OnStop() override;
-
-  // Internal events
-  virtual void OnClientConnected(RemoteChatClient &client) override;
-  virtual void OnClientDisconnected(RemoteChatClient &client) override;
-
-  // Handler functions
-  virtual ComponentType GetType() override;
-  virtual bool Handle(RemoteChatClient &client, uint16_t message_type,
-    TypedBuffer &buffer) override;
-
-  // API functions
-  bool GetChatUser(RemoteChatClient &client,
-    std::shared_ptr<ChatUser> &out_user);
-
-  // API events
-  Event<UserMessageResult, std::string &, ChatUser &> OnIdentifyCompleted;
-  Event<UserMessageResult, std::string &, std::string &,
-    ChatUser &> OnSendMessageCompleted;
-
-  Event<ChatUser &> OnIdentified;
-  Event<ChatUser &, ChatUser &, std::string> OnMessage;
-};
-}
-
-#endif // jchat_server_user_component_h_
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_server_user_component_h_
+#define jchat_server_user_component_h_
+
+#include "chat_component.h"
+#include "chat_user.h"
+#include "protocol/components/user_message_result.h"
+#include "event.hpp"
+#include "rcu.hpp"
+#include "tcp_client.hpp"
+#include <unordered_map>
+#include <memory>
+
+#ifndef JCHAT_USER_INDEX_SHARDS
+#define JCHAT_USER_INDEX_SHARDS 64
+#endif // JCHAT_USER_INDEX_SHARDS
+
+namespace jchat {
+class UserComponent : public ChatComponent {
+private:
+  ChatServer *server_;
+
+  struct UserEntry {
+    ConnectionHandle Handle;
+    std::shared_ptr<ChatUser> User;
+  };
+  typedef std::unordered_map<std::string, UserEntry> UserMap;
+
+  // Every identified user by their case folded username, spread over shards
+  // by the name's hash. Lookups read the current snapshot of a shard without
+  // locking, identifying and disconnecting publish a new one, so a write only
+  // copies its own shard. A client's own user is kept in its state slot
+  RcuPointer<UserMap> users_[JCHAT_USER_INDEX_SHARDS];
+
+  RcuPointer<UserMap> &getUsers(const std::string &folded_username);
+  void clearUsers();
+
+public:
+  UserComponent();
+  ~UserComponent();
+
+  // Internal functions
+  virtual bool Initialize(ChatServer &server) override;
+  virtual bool Shutdown() override;
+
+  virtual bool OnStart() override;
+  virtual bool OnStop() override;
+
+  // Internal events
+  virtual void OnClientConnected(RemoteChatClient &client) override;
+  virtual void OnClientDisconnected(RemoteChatClient &client) override;
+
+  // Handler functions
+  virtual ComponentType GetType() override;
+  virtual bool Handle(RemoteChatClient &client, uint16_t message_type,
+    TypedBuffer &buffer) override;
+
+  // API functions
+  bool GetChatUser(RemoteChatClient &client,
+    std::shared_ptr<ChatUser> &out_user);
+
+  // API events
+  Event<UserMessageResult, std::string &, ChatUser &> OnIdentifyCompleted;
+  Event<UserMessageResult, std::string &, std::string &,
+    ChatUser &> OnSendMessageCompleted;
+
+  Event<ChatUser &> OnIdentified;
+  Event<ChatUser &, ChatUser &, std::string> OnMessage;
+};
+}
+
+#endif // jchat_server_user_component_h_
@@ -0,0 +1,74 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#ifndef jchat_server_rate_limiter_h_
+#define jchat_server_rate_limiter_h_
+
+#include "remote_chat_client.h"
+#include "chat_channel.h"
+#include "token_bucket.hpp"
+#include <unordered_map>
+#include <mutex>
+
+#ifndef JCHAT_RATE_LIMITER_SHARDS
+#define JCHAT_RATE_LIMITER_SHARDS 64 // Must be a power of two
+#endif // JCHAT_RATE_LIMITER_SHARDS
+
+namespace jchat {
+// Limits the chat messages clients send, per client, per address and per
+// channel. A client's bucket is only used by the thread handling the client
+// and a channel's only by its mailbox, so neither is locked. The buckets of
+// addresses are spread over shards which are locked on their own, so clients
+// from different addresses rarely contend
+class RateLimiter {
+  struct AddressEntry {
+    TrafficBucket Bucket;
+    uint32_t ClientCount; // The entry goes away with its last client
+  };
+
+  struct AddressShard {
+    std::mutex Mutex;
+    std::unordered_map<uint32_t, AddressEntry> Entries;
+    uint8_t Padding[JCHAT_CACHE_LINE_SIZE];
+  };
+
+  TrafficLimit client_limit_;
+  TrafficLimit address_limit_;
+  TrafficLimit channel_limit_;
+  AddressShard address_shards_[JCHAT_RATE_LIMITER_SHARDS];
+
+  AddressShard &getAddressShard(uint32_t address);
+
+public:
+  RateLimiter();
+
+  // Every limit is off until it's set. NOTE: Set these before the server
+  // starts
+  void SetClientLimit(const TrafficLimit &limit);
+  void SetAddressLimit(const TrafficLimit &limit);
+  void SetChannelLimit(const TrafficLimit &limit);
+  TrafficLimit GetClientLimit();
+  TrafficLimit GetAddressLimit();
+  TrafficLimit GetChannelLimit();
+
+  // Called by the server as clients connect and disconnect
+  void AddClient(RemoteChatClient &client);
+  void RemoveClient(RemoteChatClient &client);
+
+  // Takes a message of the size from the client's bucket and its address's
+  // bucket, returns false if either is over its limit. NOTE: Only call this
+  // from the thread handling the client
+  bool TakeClient(RemoteChatClient &client, size_t size);
+
+  // Takes a message of the size from the channel's bucket, returns false if
+  // it's over its limit. NOTE: Only call this from the channel's mailbox
+  bool TakeChannel(ChatChannel &channel, size_t size);
+};
+}
+
+#endif // jchat_server_rate_limiter_h_
@@ -0,0 +1,160 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#include "ban_list.h"
+#include "string.hpp"
+
+namespace jchat {
+BanList::BanList() : prefix_nodes_(1), suffix_nodes_(1) {
+}
+
+void BanList::addToTrie(std::vector<Node> &nodes, const std::string &anchor,
+  uint32_t mask_index) {
+  uint32_t node = 0;
+  for (char character : anchor) {
+    uint32_t *child = nodes[node].Children.Find(character);
+    if (child != nullptr) {
+      node = *child;
+      continue;
+    }
+
+    // Add the node before linking it, adding may move the parent
+    uint32_t new_node = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes[node].Children.Set(character, new_node);
+    node = new_node;
+  }
+  nodes[node].Masks.push_back(mask_index);
+}
+
+bool BanList::isMatch(const std::string &mask, const std::string &subject) {
+  // Match greedily and on a mismatch let the last * take one more character
+  size_t mask_position = 0;
+  size_t subject_position = 0;
+  size_t star_position = std::string::npos;
+  size_t star_subject_position = 0;
+  while (subject_position < subject.size()) {
+    if (mask_position < mask.size() && (mask[mask_position] == '?'
+      || mask[mask_position] == subject[subject_position])) {
+      mask_position++;
+      subject_position++;
+    } else if (mask_position < mask.size() && mask[mask_position] == '*') {
+      star_position = mask_position++;
+      star_subject_position = subject_position;
+    } else if (star_position != std::string::npos) {
+      mask_position = star_position + 1;
+      subject_position = ++star_subject_position;
+    } else {
+      return false;
+    }
+  }
+  while (mask_position < mask.size() && mask[mask_position] == '*') {
+    mask_position++;
+  }
+  return mask_position == mask.size();
+}
+
+bool BanList::matchTrie(std::vector<Node> &nodes, const std::string &subject,
+  bool is_reversed) {
+  uint32_t node = 0;
+  for (size_t i = 0; i < subject.size(); i++) {
+    char character = subject[is_reversed ? subject.size() - 1 - i : i];
+    uint32_t *child = nodes[node].Children.Find(character);
+    if (child == nullptr) {
+      return false;
+    }
+    node = *child;
+
+    for (uint32_t mask_index : nodes[node].Masks) {
+      if (isMatch(wildcard_masks_[mask_index], subject)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool BanList::IsWildcard(const std::string &mask) {
+  return mask.find_first_of("*?") != std::string::npos;
+}
+
+bool BanList::IsMatch(const std::string &mask, const std::string &username,
+  const std::string &hostname) {
+  return isMatch(String::ToLower(mask),
+    String::ToLower(username + "@" + hostname));
+}
+
+bool BanList::Add(const std::string &mask) {
+  std::string folded_mask = String::ToLower(mask);
+  if (!folded_bans_.insert(folded_mask).second) {
+    return false;
+  }
+  bans_.push_back(mask);
+
+  // Exact masks only need the set
+  if (!IsWildcard(folded_mask)) {
+    return true;
+  }
+
+  uint32_t mask_index = static_cast<uint32_t>(wildcard_masks_.size());
+  wildcard_masks_.push_back(folded_mask);
+
+  // Index the mask by its longer literal end
+  std::string prefix = folded_mask.substr(0,
+    folded_mask.find_first_of("*?"));
+  std::string suffix = folded_mask.substr(
+    folded_mask.find_last_of("*?") + 1);
+  if (prefix.empty() && suffix.empty()) {
+    unanchored_masks_.push_back(mask_index);
+  } else if (prefix.size() >= suffix.size()) {
+    addToTrie(prefix_nodes_, prefix, mask_index);
+  } else {
+    addToTrie(suffix_nodes_, std::string(suffix.rbegin(), suffix.rend()),
+      mask_index);
+  }
+  return true;
+}
+
+bool BanList::Contains(const std::string &mask) const {
+  return folded_bans_.find(String::ToLower(mask)) != folded_bans_.end();
+}
+
+bool BanList::IsBanned(const std::string &username,
+  const std::string &hostname) {
+  if (bans_.empty()) {
+    return false;
+  }
+
+  std::string subject = String::ToLower(username + "@" + hostname);
+  if (folded_bans_.find(subject) != folded_bans_.end()) {
+    return true;
+  }
+  if (wildcard_masks_.empty()) {
+    return false;
+  }
+
+  if (matchTrie(prefix_nodes_, subject, false)
+    || matchTrie(suffix_nodes_, subject, true)) {
+    return true;
+  }
+  for (uint32_t mask_index : unanchored_masks_) {
+    if (isMatch(wildcard_masks_[mask_index], subject)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const std::vector<std::string> &BanList::GetBans() const {
+  return bans_;
+}
+
+size_t BanList::GetSize() const {
+  return bans_.size();
+}
+}
@@ -1,288 +1,442 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#include "chat_server.h"
-
-namespace jchat {
-ChatServer::ChatServer(const char *hostname, uint16_t port)
-  : tcp_server_(hostname, port), is_listening_(false) {
-  int16_t number = 0x00FF;
-  is_little_endian_ = ((uint8_t *)&number)[0] == 0xFF;
-
-  tcp_server_.OnClientConnected.Add([this](TcpClient &client) {
-    return onClientConnected(client);
-  });
-  tcp_server_.OnClientDisconnected.Add([this](TcpClient &client) {
-    return onClientDisconnected(client);
-  });
-  tcp_server_.OnDataReceived.Add([this](TcpClient &client, Buffer &buffer) {
-    return onDataReceived(client, buffer);
-  });
-}
-
-ChatServer::~ChatServer() {
-  // Remove clients
-  if (!clients_.empty()) {
-    for (auto client : clients_) {
-      client.first->Disconnect();
-      delete client.second;
-    }
-    clients_.clear();
-  }
-}
-
-bool ChatServer::Start() {
-  if (is_listening_) {
-    return false;
-  }
-
-  if (!tcp_server_.Start()) {
-    return false;
-  }
-
-  for (auto component : components_) {
-    component->OnStart();
-  }
-
-  is_listening_ = true;
-
-  return true;
-}
-
-bool ChatServer::Stop() {
-  if (!is_listening_) {
-    return false;
-  }
-
-  if (!tcp_server_.Stop()) {
-    return false;
-  }
-
-  // Remove clients
-  clients_mutex_.lock();
-  if (!clients_.empty()) {
-    for (auto client : clients_) {
-      client.first->Disconnect();
-      delete client.second;
-    }
-    clients_.clear();
-  }
-  clients_mutex_.unlock();
-
-  for (auto component : components_) {
-    component->OnStop();
-  }
-
-  is_listening_ = false;
-
-  return true;
-}
-
-bool ChatServer::AddComponent(std::shared_ptr<ChatComponent> component) {
-  if (is_listening_) {
-    return false;
-  }
-
-  for (auto it = components_.begin(); it != components_.end(); ++it) {
-    if (*it == component) {
-      return false;
-    }
-  }
-  if (!component->Initialize(*this)) {
-    return false;
-  }
-  components_.push_back(component);
-
-  return true;
-}
-
-bool ChatServer::RemoveComponent(std::shared_ptr<ChatComponent> component) {
-  if (is_listening_) {
-    return false;
-  }
-
-  for (auto it = components_.begin(); it != components_.end(); ++it) {
-    if (*it == component) {
-      if (!component->Shutdown()) {
-		    return false;
-      }
-      components_.erase(it);
-      return true;
-    }
-  }
-
-  return false;
-}
-
-bool ChatServer::GetComponent(ComponentType component_type,
-  std::shared_ptr<ChatComponent> &out_component) {
-  for (auto component : components_) {
-    if (component->GetType() == component_type) {
-      out_component = component;
-      return true;
-    }
-  }
-  return false;
-}
-
-TypedBuffer ChatServer::CreateBuffer() {
-    return TypedBuffer(!is_little_endian_);
-}
-
-bool ChatServer::Send(RemoteChatClient &client,
-  ComponentType component_type, uint8_t message_type, TypedBuffer &buffer) {
-  TcpClient *tcp_client = NULL;
-  if (!getTcpClient(client, &tcp_client)) {
-    return false;
-  }
-  return send(*tcp_client, component_type, message_type, buffer);
-}
-
-bool ChatServer::Send(RemoteChatClient *client,
-  ComponentType component_type, uint8_t message_type, TypedBuffer &buffer) {
-  TcpClient *tcp_client = NULL;
-  if (!getTcpClient(*client, &tcp_client)) {
-    return false;
-  }
-  return send(*tcp_client, component_type, message_type, buffer);
-}
-
-IPEndpoint ChatServer::GetListenEndpoint() {
-  return tcp_server_.GetListenEndpoint();
-}
-
-bool ChatServer::onClientConnected(TcpClient &tcp_client) {
-  RemoteChatClient *chat_client = new RemoteChatClient();
-
-  // Set the endpoint for the client as the remote endpoint (the client's
-  // address and port)
-  chat_client->Endpoint = tcp_client.GetRemoteEndpoint();
-
-  for (auto component : components_) {
-    component->OnClientConnected(*chat_client);
-  }
-
-  clients_mutex_.lock();
-  clients_[&tcp_client] = chat_client;
-  clients_mutex_.unlock();
-
-  OnClientConnected(*chat_client);
-
-  return true;
-}
-
-bool ChatServer::onClientDisconnected(TcpClient &tcp_client) {
-  clients_mutex_.lock();
-  RemoteChatClient *chat_client = clients_[&tcp_client];
-  clients_mutex_.unlock();
-
-  for (auto component : components_) {
-    component->OnClientDisconnected(*chat_client);
-  }
-
-  // TODO/NOTE: We need to remove the client from any channels where they're in
-  // or where they have operator or any privileges, and we can do this in the
-  // appropriate components using the OnClientDisconnected, etc. events within
-  // them -- And remove those channel/identified things from the
-  // RemoteChatClient class
-  OnClientDisconnected(*chat_client);
-
-  // Remove client
-  clients_mutex_.lock();
-  clients_.erase(&tcp_client);
-  clients_mutex_.unlock();
-
-  delete chat_client;
-
-  return true;
-}
-
-bool ChatServer::onDataReceived(TcpClient &tcp_client, Buffer &buffer) {
-  uint8_t component_type = 0;
-  uint16_t message_type = 0;
-  uint32_t size = 0;
-
-  // Determine the header size
-  size_t header_size = sizeof(component_type) + sizeof(message_type)
-    + sizeof(size);
-
-  // Flip data endian order if needed
-  buffer.SetFlipEndian(!is_little_endian_);
-
-  // Try to handle the requests, if any are unhandled, drop the connection
-  bool handled = false;
-
-  // Keep reading the buffer till the end
-  while (buffer.GetSize() - buffer.GetPosition() >= header_size) {
-    // Check if the packet is valid
-    if (!buffer.Read(&component_type) || !buffer.Read(&message_type)
-      || !buffer.Read(&size) || buffer.GetSize() - buffer.GetPosition() < size
-      || component_type >= kComponentType_Max) {
-
-      // Drop connection
-      return false;
-    }
-
-    // Read the packet into a typed buffer
-    TypedBuffer typed_buffer(buffer.GetBuffer() + buffer.GetPosition(),
-      size, !is_little_endian_);
-
-    // Increase the position of the buffer
-    buffer.SetPosition(buffer.GetPosition() + size);
-
-    clients_mutex_.lock();
-    RemoteChatClient *chat_client = clients_[&tcp_client];
-    clients_mutex_.unlock();
-
-    for (auto component : components_) {
-      if (component->GetType() == static_cast<ComponentType>(component_type)) {
-        if (component->Handle(*chat_client, message_type, typed_buffer)) {
-          handled = true;
-          break;
-        }
-      }
-    }
-  }
-
-  return handled;
-}
-
-bool ChatServer::getTcpClient(RemoteChatClient &client,
-  TcpClient **out_client) {
-  clients_mutex_.lock();
-  for (auto pair : clients_) {
-    if (pair.second == &client) {
-      clients_mutex_.unlock();
-      *out_client = pair.first;
-      return true;
-    }
-  }
-  clients_mutex_.unlock();
-  return false;
-}
-
-bool ChatServer::send(TcpClient &client, ComponentType component_type,
-  uint8_t message_type, TypedBuffer &buffer) {
-  Buffer temp_buffer(!is_little_endian_);
-
-  // Write header
-  temp_buffer.Write<uint8_t>(component_type);
-  temp_buffer.Write<uint16_t>(message_type);
-  temp_buffer.Write<uint32_t>(buffer.GetSize());
-
-  // Write body
-  temp_buffer.WriteArray<uint8_t>(buffer.GetBuffer(), buffer.GetSize());
-
-  return tcp_server_.Send(client, temp_buffer);
-}
-
-bool ChatServer::send(TcpClient *client, ComponentType component_type,
-  uint8_t message_type, TypedBuffer &buffer) {
-  return send(*client, component_type, message_type, buffer);
-}
-}
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#include "chat_server.h"
+
+namespace jchat {
+ChatServer::ChatServer(const char *hostname, uint16_t port,
+  uint32_t thread_count) : tcp_server_(hostname, port, thread_count),
+  is_listening_(false), state_count_(0), worker_count_(0) {
+  int16_t number = 0x00FF;
+  is_little_endian_ = ((uint8_t *)&number)[0] == 0xFF;
+
+  tcp_server_.OnClientConnected.Add([this](TcpClient &client) {
+    return onClientConnected(client);
+  });
+  tcp_server_.OnClientDisconnected.Add([this](TcpClient &client) {
+    return onClientDisconnected(client);
+  });
+  tcp_server_.OnDataReceived.Add([this](TcpClient &client, Buffer &buffer) {
+    return onDataReceived(client, buffer);
+  });
+}
+
+ChatServer::~ChatServer() {
+  // Remove clients
+  for (auto client : clients_) {
+    if (client != nullptr) {
+      tcp_server_.DisconnectClient(client->Handle);
+      delete client;
+    }
+  }
+  clients_.clear();
+}
+
+bool ChatServer::Start() {
+  if (is_listening_) {
+    return false;
+  }
+
+  if (worker_count_ > 0 && !executor_.Start(worker_count_)) {
+    return false;
+  }
+
+  if (!tcp_server_.Start()) {
+    executor_.Stop();
+    return false;
+  }
+
+  for (auto component : components_) {
+    component->OnStart();
+  }
+
+  is_listening_ = true;
+
+  return true;
+}
+
+bool ChatServer::Stop() {
+  if (!is_listening_) {
+    return false;
+  }
+
+  if (!tcp_server_.Stop()) {
+    return false;
+  }
+
+  // Let the workers finish with the clients which were just disconnected
+  executor_.Stop();
+
+  // Remove clients
+  clients_mutex_.lock();
+  for (auto client : clients_) {
+    if (client != nullptr) {
+      delete client;
+    }
+  }
+  clients_.clear();
+  strands_.clear();
+  clients_mutex_.unlock();
+
+  for (auto component : components_) {
+    component->OnStop();
+  }
+
+  is_listening_ = false;
+
+  return true;
+}
+
+bool ChatServer::AddComponent(std::shared_ptr<ChatComponent> component) {
+  if (is_listening_) {
+    return false;
+  }
+
+  for (auto it = components_.begin(); it != components_.end(); ++it) {
+    if (*it == component) {
+      return false;
+    }
+  }
+  if (!component->Initialize(*this)) {
+    return false;
+  }
+  components_.push_back(component);
+
+  // Make room for the component's state on every client
+  if (component->GetType() >= state_count_) {
+    state_count_ = component->GetType() + 1;
+  }
+
+  return true;
+}
+
+bool ChatServer::RemoveComponent(std::shared_ptr<ChatComponent> component) {
+  if (is_listening_) {
+    return false;
+  }
+
+  for (auto it = components_.begin(); it != components_.end(); ++it) {
+    if (*it == component) {
+      if (!component->Shutdown()) {
+		    return false;
+      }
+      components_.erase(it);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ChatServer::GetComponent(ComponentType component_type,
+  std::shared_ptr<ChatComponent> &out_component) {
+  for (auto component : components_) {
+    if (component->GetType() == component_type) {
+      out_component = component;
+      return true;
+    }
+  }
+  return false;
+}
+
+TypedBuffer ChatServer::CreateBuffer() {
+    return TypedBuffer(!is_little_endian_);
+}
+
+bool ChatServer::Send(RemoteChatClient &client,
+  ComponentType component_type, uint8_t message_type, TypedBuffer &buffer,
+  SendPriority priority) {
+  return send(client.Handle, component_type, message_type, buffer, priority);
+}
+
+bool ChatServer::Send(RemoteChatClient *client,
+  ComponentType component_type, uint8_t message_type, TypedBuffer &buffer,
+  SendPriority priority) {
+  return send(client->Handle, component_type, message_type, buffer, priority);
+}
+
+bool ChatServer::Send(ConnectionHandle handle, ComponentType component_type,
+  uint8_t message_type, TypedBuffer &buffer, SendPriority priority) {
+  return send(handle, component_type, message_type, buffer, priority);
+}
+
+size_t ChatServer::Broadcast(const std::vector<ConnectionHandle> &handles,
+  ComponentType component_type, uint8_t message_type, TypedBuffer &buffer,
+  ConnectionHandle skip_handle, SendPriority priority) {
+  if (handles.empty()) {
+    return 0;
+  }
+  SharedFrame frame = createFrame(component_type, message_type, buffer);
+  return tcp_server_.Broadcast(handles.data(), handles.size(), frame,
+    skip_handle, priority);
+}
+
+size_t ChatServer::GetSendQueueSize(RemoteChatClient &client) {
+  std::shared_ptr<TcpClient> tcp_client;
+  if (!getTcpClient(client, tcp_client)) {
+    return 0;
+  }
+  return tcp_client->GetSendQueueSize();
+}
+
+RateLimiter &ChatServer::GetRateLimiter() {
+  return rate_limiter_;
+}
+
+IPEndpoint ChatServer::GetListenEndpoint() {
+  return tcp_server_.GetListenEndpoint();
+}
+
+TcpServer &ChatServer::GetTcpServer() {
+  return tcp_server_;
+}
+
+bool ChatServer::SetWorkerCount(uint32_t worker_count) {
+  if (is_listening_) {
+    return false;
+  }
+  worker_count_ = worker_count;
+  return true;
+}
+
+uint32_t ChatServer::GetWorkerCount() {
+  return worker_count_;
+}
+
+Executor &ChatServer::GetExecutor() {
+  return executor_;
+}
+
+bool ChatServer::onClientConnected(TcpClient &tcp_client) {
+  RemoteChatClient *chat_client = new RemoteChatClient();
+
+  // Set the endpoint for the client as the remote endpoint (the client's
+  // address and port)
+  chat_client->Endpoint = tcp_client.GetRemoteEndpoint();
+  chat_client->Handle = tcp_client.GetHandle();
+  chat_client->States.resize(state_count_);
+  rate_limiter_.AddClient(*chat_client);
+
+  std::shared_ptr<Strand> strand;
+  if (worker_count_ > 0) {
+    strand = std::make_shared<Strand>(executor_);
+  }
+
+  clients_mutex_.lock();
+  if (chat_client->Handle.Index >= clients_.size()) {
+    clients_.resize(chat_client->Handle.Index + 1, nullptr);
+    strands_.resize(chat_client->Handle.Index + 1);
+  }
+  clients_[chat_client->Handle.Index] = chat_client;
+  strands_[chat_client->Handle.Index] = strand;
+  clients_mutex_.unlock();
+
+  if (strand) {
+    strand->Post([this, chat_client]() {
+      connectClient(chat_client);
+    });
+  } else {
+    connectClient(chat_client);
+  }
+
+  return true;
+}
+
+bool ChatServer::onClientDisconnected(TcpClient &tcp_client) {
+  std::shared_ptr<Strand> strand;
+  RemoteChatClient *chat_client = getChatClient(tcp_client.GetHandle(),
+    &strand);
+  if (chat_client == nullptr) {
+    return false;
+  }
+
+  // Remove client, the slot can be taken by a new client from here on
+  clients_mutex_.lock();
+  clients_[chat_client->Handle.Index] = nullptr;
+  strands_[chat_client->Handle.Index].reset();
+  clients_mutex_.unlock();
+  rate_limiter_.RemoveClient(*chat_client);
+
+  // The client is deleted after any messages from it which are still queued
+  if (strand) {
+    strand->Post([this, chat_client]() {
+      disconnectClient(chat_client);
+    });
+  } else {
+    disconnectClient(chat_client);
+  }
+
+  return true;
+}
+
+bool ChatServer::onDataReceived(TcpClient &tcp_client, Buffer &buffer) {
+  uint8_t component_type = 0;
+  uint16_t message_type = 0;
+  uint32_t size = 0;
+
+  // Determine the header size
+  size_t header_size = sizeof(component_type) + sizeof(message_type)
+    + sizeof(size);
+
+  // Flip data endian order if needed
+  buffer.SetFlipEndian(!is_little_endian_);
+
+  std::shared_ptr<Strand> strand;
+  RemoteChatClient *chat_client = getChatClient(tcp_client.GetHandle(),
+    &strand);
+  if (chat_client == nullptr) {
+    return false;
+  }
+
+  // Handle every complete packet in the buffer, whatever is left over is the
+  // start of a packet which hasn't been fully received yet
+  while (buffer.GetSize() - buffer.GetPosition() >= header_size) {
+    size_t packet_position = buffer.GetPosition();
+
+    // Check if the packet is valid
+    if (!buffer.Read(&component_type) || !buffer.Read(&message_type)
+      || !buffer.Read(&size) || size > JCHAT_CHAT_FRAME_SIZE_LIMIT
+      || component_type >= kComponentType_Max) {
+      // Drop connection
+      return false;
+    }
+
+    // Wait for the rest of the packet, or for the client's next turn if it
+    // has dispatched enough for this one
+    if (buffer.GetSize() - buffer.GetPosition() < size
+      || !tcp_client.TakeFrameBudget()) {
+      buffer.SetPosition(packet_position);
+      break;
+    }
+
+    // Read the packet into a typed buffer
+    auto typed_buffer = std::make_shared<TypedBuffer>(buffer.GetBuffer()
+      + buffer.GetPosition(), size, !is_little_endian_);
+
+    // Increase the position of the buffer
+    buffer.SetPosition(buffer.GetPosition() + size);
+
+    // Try to handle the request, if it's unhandled, drop the connection
+    if (!strand) {
+      if (!handleMessage(*chat_client, component_type, message_type,
+        *typed_buffer)) {
+        return false;
+      }
+      continue;
+    }
+    strand->Post([this, chat_client, component_type, message_type,
+      typed_buffer]() {
+      if (!handleMessage(*chat_client, component_type, message_type,
+        *typed_buffer)) {
+        // The reactor closes the connection once it sees it's shut down
+        tcp_server_.DisconnectClient(chat_client->Handle);
+      }
+    });
+  }
+
+  return true;
+}
+
+void ChatServer::connectClient(RemoteChatClient *chat_client) {
+  for (auto component : components_) {
+    component->OnClientConnected(*chat_client);
+  }
+
+  OnClientConnected(*chat_client);
+}
+
+void ChatServer::disconnectClient(RemoteChatClient *chat_client) {
+  for (auto component : components_) {
+    component->OnClientDisconnected(*chat_client);
+  }
+
+  // TODO/NOTE: We need to remove the client from any channels where they're in
+  // or where they have operator or any privileges, and we can do this in the
+  // appropriate components using the OnClientDisconnected, etc. events within
+  // them -- And remove those channel/identified things from the
+  // RemoteChatClient class
+  OnClientDisconnected(*chat_client);
+
+  delete chat_client;
+}
+
+bool ChatServer::handleMessage(RemoteChatClient &chat_client,
+  uint8_t component_type, uint16_t message_type, TypedBuffer &buffer) {
+  for (auto component : components_) {
+    if (component->GetType() == static_cast<ComponentType>(component_type)) {
+      if (component->Handle(chat_client, message_type, buffer)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+RemoteChatClient *ChatServer::getChatClient(ConnectionHandle handle,
+  std::shared_ptr<Strand> *out_strand) {
+  std::lock_guard<std::mutex> clients_lock(clients_mutex_);
+  if (handle.Index >= clients_.size()) {
+    return nullptr;
+  }
+  // The slot may already belong to a newer client
+  RemoteChatClient *chat_client = clients_[handle.Index];
+  if (chat_client == nullptr || chat_client->Handle != handle) {
+    return nullptr;
+  }
+  if (out_strand != nullptr) {
+    *out_strand = strands_[handle.Index];
+  }
+  return chat_client;
+}
+
+bool ChatServer::getTcpClient(RemoteChatClient &client,
+  std::shared_ptr<TcpClient> &out_client) {
+  // This takes a reference while the client is still registered, so that it
+  // stays alive even if its reactor disconnects it while we use it
+  return tcp_server_.GetClient(client.Handle, out_client);
+}
+
+bool ChatServer::send(ConnectionHandle handle, ComponentType component_type,
+  uint8_t message_type, TypedBuffer &buffer, SendPriority priority) {
+  // In sharded mode the message is most likely handed over to the client's
+  // reactor, so it's encoded into a frame the reactor can share
+  if (tcp_server_.IsSharded()) {
+    return tcp_server_.Send(handle, createFrame(component_type,
+      message_type, buffer), priority);
+  }
+
+  // Write the header on its own and send the body straight from the typed
+  // buffer behind it, so the body isn't copied
+  Buffer header(!is_little_endian_);
+  header.Write<uint8_t>(component_type);
+  header.Write<uint16_t>(message_type);
+  header.Write<uint32_t>(buffer.GetSize());
+
+  SendChunk frame[] = {
+    { header.GetBuffer(), header.GetSize() },
+    { buffer.GetBuffer(), buffer.GetSize() }
+  };
+  return tcp_server_.Send(handle, frame, 2, priority);
+}
+
+SharedFrame ChatServer::createFrame(ComponentType component_type,
+  uint8_t message_type, TypedBuffer &buffer) {
+  Buffer header(!is_little_endian_);
+  header.Write<uint8_t>(component_type);
+  header.Write<uint16_t>(message_type);
+  header.Write<uint32_t>(buffer.GetSize());
+
+  auto frame = std::make_shared<std::vector<uint8_t>>();
+  frame->reserve(header.GetSize() + buffer.GetSize());
+  frame->insert(frame->end(), header.GetBuffer(),
+    header.GetBuffer() + header.GetSize());
+  frame->insert(frame->end(), buffer.GetBuffer(),
+    buffer.GetBuffer() + buffer.GetSize());
+  return frame;
+}
+}
@@ -1,1137 +1,1377 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-#include "components/channel_component.h"
-#include "components/user_component.h"
-#include "chat_server.h"
-#include "protocol/protocol.h"
-#include "protocol/components/channel_message_type.h"
-#include "string.hpp"
-
-namespace jchat {
-ChannelComponent::ChannelComponent() {
-}
-
-ChannelComponent::~ChannelComponent() {
-  if (!channels_.empty()) {
-    channels_.clear();
-  }
-}
-
-bool ChannelComponent::Initialize(ChatServer &server) {
-  server_ = &server;
-  return true;
-}
-
-bool ChannelComponent::Shutdown() {
-  server_ = 0;
-
-  // Remove channels
-  channels_mutex_.lock();
-  if (!channels_.empty()) {
-    channels_.clear();
-  }
-  channels_mutex_.unlock();
-
-  return true;
-}
-
-bool ChannelComponent::OnStart() {
-  return true;
-}
-
-bool ChannelComponent::OnStop() {
-  // Remove channels
-  channels_mutex_.lock();
-  if (!channels_.empty()) {
-    channels_.clear();
-  }
-  channels_mutex_.unlock();
-
-  return true;
-}
-
-void ChannelComponent::OnClientConnected(RemoteChatClient &client) {
-
-}
-
-void ChannelComponent::OnClientDisconnected(RemoteChatClient &client) {
-  // Notify all clients in participating channels that the client has
-  // disconnected
-  channels_mutex_.lock();
-  for (auto it = channels_.begin(); it != channels_.end(); ++it) {
-    std::shared_ptr<ChatChannel> channel = *it;
-
-    if (channel->Enabled) {
-      channel->ClientsMutex.lock();
-      if (channel->Clients.find(&client) != channel->Clients.end()) {
-        // Get the chat user
-        std::shared_ptr<ChatUser> chat_user = channel->Clients[&client];
-
-        // Notify all clients in that channel that the client left
-        TypedBuffer clients_buffer = server_->CreateBuffer();
-        clients_buffer.WriteUInt16(kChannelMessageResult_UserLeft);
-        clients_buffer.WriteString(channel->Name);
-        clients_buffer.WriteString(chat_user->Username);
-        clients_buffer.WriteString(chat_user->Hostname);
-
-        for (auto &pair : channel->Clients) {
-          if (pair.first != &client && pair.second->Enabled) {
-            server_->Send(pair.first, kComponentType_Channel,
-              kChannelMessageType_LeaveChannel, clients_buffer);
-          }
-        }
-
-        // Trigger the events
-        OnChannelLeft(*channel, *chat_user);
-
-        // Remove the client from the clients list
-        channel->Clients.erase(&client);
-
-        // If there was nobody in the channel delete it
-        if (channel->Clients.empty()) {
-          channel->ClientsMutex.unlock();
-          channel->OperatorsMutex.lock();
-          channel->Operators.clear();
-          channel->OperatorsMutex.unlock();
-          channel->Enabled = false;
-          channel.reset();
-          continue;
-        }
-      }
-      channel->ClientsMutex.unlock();
-
-      // Remove the client from the operators list if they're an operator
-      channel->OperatorsMutex.lock();
-      if (channel->Operators.find(&client)
-        != channel->Operators.end()) {
-        channel->Operators.erase(&client);
-      }
-      channel->OperatorsMutex.unlock();
-    }
-  }
-  channels_mutex_.unlock();
-}
-
-ComponentType ChannelComponent::GetType() {
-  return kComponentType_Channel;
-}
-
-bool ChannelComponent::Handle(RemoteChatClient &client, uint16_t message_type,
-  TypedBuffer &buffer) {
-  if (message_type == kChannelMessageType_JoinChannel) {
-    std::string channel_name;
-    if (!buffer.ReadString(channel_name)) {
-      return false;
-    }
-
-    // Get user component
-    std::shared_ptr<UserComponent> user_component;
-    if (!server_->GetComponent(kComponentType_User, user_component)) {
-      // Internal error, disconnect client
-      return false;
-    }
-
-    // Get the chat client
-    std::shared_ptr<ChatUser> chat_user;
-    if (!user_component->GetChatUser(client, chat_user)) {
-      // Internal error, disconnect client
-      return false;
-    }
-
-    // Check if the user is logged in
-    if (!chat_user->Identified) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotIdentified);
-	    send_buffer.WriteString(channel_name);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_JoinChannel_Complete, send_buffer);
-
-      // Trigger events
-      OnJoinCompleted(kChannelMessageResult_NotIdentified, channel_name,
-        *chat_user);
-
-      return true;
-    }
-
-    // Check if the channel name is valid
-    if (channel_name.empty() || channel_name[0] != '#') {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
-      send_buffer.WriteString(channel_name);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_JoinChannel_Complete, send_buffer);
-
-      // Trigger events
-      OnJoinCompleted(kChannelMessageResult_InvalidChannelName, channel_name,
-        *chat_user);
-
-      return true;
-    }
-
-    // Check if the channel exists
-    std::shared_ptr<ChatChannel> chat_channel;
-    channels_mutex_.lock();
-    for (auto &channel : channels_) {
-      if (channel->Enabled && channel->Name == channel_name) {
-        chat_channel = channel;
-        break;
-      }
-    }
-    channels_mutex_.unlock();
-
-    if (!chat_channel) {
-      // Check if the channel name is too long
-      if (channel_name.size() - 1 > JCHAT_CHAT_CHANNEL_NAME_LENGTH) {
-        TypedBuffer send_buffer = server_->CreateBuffer();
-        send_buffer.WriteUInt16(kChannelMessageResult_ChannelNameTooLong);
-        send_buffer.WriteString(channel_name);
-        server_->Send(client, kComponentType_User,
-          kChannelMessageType_JoinChannel_Complete, send_buffer);
-
-        // Trigger events
-        OnJoinCompleted(kChannelMessageResult_ChannelNameTooLong, channel_name,
-          *chat_user);
-
-        return true;
-      }
-
-      // Create the channel and add the user to it
-      chat_channel = std::make_shared<ChatChannel>();
-      chat_channel->Enabled = true;
-      chat_channel->Name = channel_name;
-      chat_channel->Operators[&client] = chat_user;
-      chat_channel->Clients[&client] = chat_user;
-
-      // Add the channel to the component
-      channels_mutex_.lock();
-      channels_.push_back(chat_channel);
-      channels_mutex_.unlock();
-
-      // Notify the client that the channel was created and that they are
-      // the operator operator and member of it
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_ChannelCreated);
-      send_buffer.WriteString(channel_name);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_JoinChannel_Complete, send_buffer);
-
-      // Trigger the events
-      OnJoinCompleted(kChannelMessageResult_ChannelCreated, channel_name,
-        *chat_user);
-
-      OnChannelCreated(*chat_channel);
-      OnChannelJoined(*chat_channel, *chat_user);
-
-      return true;
-    }
-
-    // Check if the user is already in the channel
-    chat_channel->ClientsMutex.lock();
-    if (chat_channel->Clients.find(&client) != chat_channel->Clients.end()) {
-      chat_channel->ClientsMutex.unlock();
-
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_AlreadyInChannel);
-      send_buffer.WriteString(chat_channel->Name);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_JoinChannel_Complete, send_buffer);
-
-      // Trigger events
-      OnJoinCompleted(kChannelMessageResult_AlreadyInChannel,
-        chat_channel->Name, *chat_user);
-
-      return true;
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Check if the user is banned
-    chat_channel->BannedUsersMutex.lock();
-    std::string chat_user_hostinfo = chat_user->Username + "@"
-      + chat_user->Hostname;
-    for (auto &banned_user : chat_channel->BannedUsers) {
-      if (banned_user == chat_user_hostinfo) {
-        chat_channel->BannedUsersMutex.unlock();
-
-        TypedBuffer send_buffer = server_->CreateBuffer();
-        send_buffer.WriteUInt16(kChannelMessageResult_BannedFromChannel);
-        send_buffer.WriteString(chat_channel->Name);
-        server_->Send(client, kComponentType_Channel,
-          kChannelMessageType_JoinChannel_Complete, send_buffer);
-
-        // Trigger events
-        OnJoinCompleted(kChannelMessageResult_BannedFromChannel,
-          chat_channel->Name, *chat_user);
-
-        return true;
-      }
-    }
-    chat_channel->BannedUsersMutex.unlock();
-
-    // Add the user to the channel
-    chat_channel->ClientsMutex.lock();
-    chat_channel->Clients[&client] = chat_user;
-    chat_channel->ClientsMutex.unlock();
-
-    // Notify the client that it joined the channel and give it a list of
-    // current clients
-    TypedBuffer client_buffer = server_->CreateBuffer();
-    client_buffer.WriteUInt16(kChannelMessageResult_Ok); // Channel joined
-    client_buffer.WriteString(chat_channel->Name);
-
-    chat_channel->OperatorsMutex.lock();
-    chat_channel->ClientsMutex.lock();
-    size_t client_count = 0;
-    for (auto &pair : chat_channel->Clients) {
-      if (pair.first != &client && pair.second->Enabled) {
-        client_count++;
-      }
-    }
-    client_buffer.WriteUInt64(client_count);
-    for (auto &pair : chat_channel->Clients) {
-      if (pair.first != &client && pair.second->Enabled) {
-        client_buffer.WriteString(pair.second->Username);
-        client_buffer.WriteString(pair.second->Hostname);
-        client_buffer.WriteBoolean(
-          chat_channel->Operators.find(pair.first)
-          != chat_channel->Operators.end());
-      }
-    }
-    chat_channel->ClientsMutex.unlock();
-    chat_channel->OperatorsMutex.unlock();
-
-    chat_channel->BannedUsersMutex.lock();
-    client_buffer.WriteUInt64(chat_channel->BannedUsers.size());
-    for (auto &banned_user : chat_channel->BannedUsers) {
-      client_buffer.WriteString(banned_user);
-    }
-    chat_channel->BannedUsersMutex.unlock();
-
-    server_->Send(client, kComponentType_Channel,
-      kChannelMessageType_JoinChannel_Complete, client_buffer);
-
-    // Notify all clients in the channel that the user has joined
-    TypedBuffer clients_buffer = server_->CreateBuffer();
-    clients_buffer.WriteUInt16(kChannelMessageResult_UserJoined);
-    clients_buffer.WriteString(chat_channel->Name);
-    clients_buffer.WriteString(chat_user->Username);
-    clients_buffer.WriteString(chat_user->Hostname);
-
-    chat_channel->ClientsMutex.lock();
-    for (auto &pair : chat_channel->Clients) {
-      if (pair.first != &client && pair.second->Enabled) {
-        server_->Send(pair.first, kComponentType_Channel,
-          kChannelMessageType_JoinChannel, clients_buffer);
-      }
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Trigger the events
-    OnJoinCompleted(kChannelMessageResult_Ok, chat_channel->Name, *chat_user);
-    OnChannelJoined(*chat_channel, *chat_user);
-
-    return true;
-  } else if (message_type == kChannelMessageType_LeaveChannel) {
-    std::string channel_name;
-    if (!buffer.ReadString(channel_name)) {
-      return false;
-    }
-
-    // Get user component
-    std::shared_ptr<UserComponent> user_component;
-    if (!server_->GetComponent(kComponentType_User, user_component)) {
-      // Internal error, disconnect client
-      return false;
-    }
-
-    // Get the chat client
-    std::shared_ptr<ChatUser> chat_user;
-    if (!user_component->GetChatUser(client, chat_user)) {
-      // Internal error, disconnect client
-      return false;
-    }
-
-    // Check if the user is logged in
-    if (!chat_user->Identified) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotIdentified);
-      send_buffer.WriteString(channel_name);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_LeaveChannel_Complete, send_buffer);
-
-      // Trigger events
-      OnLeaveCompleted(kChannelMessageResult_NotIdentified, channel_name,
-        *chat_user);
-
-      return true;
-    }
-
-    // Check if the channel name is valid
-    if (channel_name.empty() || channel_name[0] != '#') {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
-      send_buffer.WriteString(channel_name);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_LeaveChannel_Complete, send_buffer);
-
-      // Trigger events
-      OnLeaveCompleted(kChannelMessageResult_InvalidChannelName, channel_name,
-        *chat_user);
-
-      return true;
-    }
-
-    // Check if the channel exists
-    std::shared_ptr<ChatChannel> chat_channel;
-    channels_mutex_.lock();
-    for (auto &channel : channels_) {
-      if (channel->Enabled && channel->Name == channel_name) {
-        chat_channel = channel;
-        break;
-      }
-    }
-    channels_mutex_.unlock();
-
-    if (!chat_channel) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
-      send_buffer.WriteString(channel_name);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_LeaveChannel_Complete, send_buffer);
-
-      // Trigger events
-      OnLeaveCompleted(kChannelMessageResult_InvalidChannelName, channel_name,
-        *chat_user);
-
-      return true;
-    }
-
-    // Check if the user is in the channel
-    chat_channel->ClientsMutex.lock();
-    if (chat_channel->Clients.find(&client) == chat_channel->Clients.end()) {
-      chat_channel->ClientsMutex.unlock();
-
-      // Notify the client that they are not in the channel
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotInChannel);
-      send_buffer.WriteString(chat_channel->Name);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_LeaveChannel_Complete, send_buffer);
-
-      // Trigger events
-      OnLeaveCompleted(kChannelMessageResult_NotInChannel, chat_channel->Name,
-        *chat_user);
-
-      return true;
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Notify all clients in that channel that the client left
-    TypedBuffer clients_buffer = server_->CreateBuffer();
-    clients_buffer.WriteUInt16(kChannelMessageResult_UserLeft);
-    clients_buffer.WriteString(chat_channel->Name);
-    clients_buffer.WriteString(chat_user->Username);
-    clients_buffer.WriteString(chat_user->Hostname);
-
-    chat_channel->ClientsMutex.lock();
-    for (auto &pair : chat_channel->Clients) {
-      if (pair.first != &client && pair.second->Enabled) {
-        server_->Send(pair.first, kComponentType_Channel,
-          kChannelMessageType_LeaveChannel, clients_buffer);
-      }
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Notify the client that they left the channel
-    TypedBuffer send_buffer = server_->CreateBuffer();
-    send_buffer.WriteUInt16(kChannelMessageResult_Ok);
-    send_buffer.WriteString(chat_channel->Name);
-    server_->Send(client, kComponentType_Channel,
-      kChannelMessageType_LeaveChannel_Complete, send_buffer);
-
-    // Trigger events
-    OnLeaveCompleted(kChannelMessageResult_Ok, chat_channel->Name, *chat_user);
-    OnChannelLeft(*chat_channel, *chat_user);
-
-    // Remove the client from the clients list
-    chat_channel->Clients.erase(&client);
-
-    // Remove the client from the operators list if they're an operator
-    chat_channel->OperatorsMutex.lock();
-    if (chat_channel->Operators.find(&client)
-      != chat_channel->Operators.end()) {
-      chat_channel->Operators.erase(&client);
-    }
-    chat_channel->OperatorsMutex.unlock();
-
-    // If there was nobody in the channel delete it
-    chat_channel->ClientsMutex.lock();
-    if (chat_channel->Clients.empty()) {
-      chat_channel->ClientsMutex.unlock();
-      chat_channel->Enabled = false;
-      chat_channel.reset();
-    } else {
-      chat_channel->ClientsMutex.unlock();
-    }
-
-    return true;
-  } else if (message_type == kChannelMessageType_SendMessage) {
-    std::string channel_name;
-    if (!buffer.ReadString(channel_name)) {
-      return false;
-    }
-
-    std::string message;
-    if (!buffer.ReadString(message)) {
-      return false;
-    }
-
-    // Get user component
-    std::shared_ptr<UserComponent> user_component;
-    if (!server_->GetComponent(kComponentType_User, user_component)) {
-      // Internal error, disconnect client
-      return false;
-    }
-
-    // Get the chat client
-    std::shared_ptr<ChatUser> chat_user;
-    if (!user_component->GetChatUser(client, chat_user)) {
-      // Internal error, disconnect client
-      return false;
-    }
-
-    // Check if the user is logged in
-    if (!chat_user->Identified) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotIdentified);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(message);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_SendMessage_Complete, send_buffer);
-
-      // Trigger events
-      OnSendMessageCompleted(kChannelMessageResult_NotIdentified, channel_name,
-        message, *chat_user);
-
-      return true;
-    }
-
-    // Check if the channel name is valid
-    if (channel_name.empty() || channel_name[0] != '#') {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(message);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_SendMessage_Complete, send_buffer);
-
-      // Trigger events
-      OnSendMessageCompleted(kChannelMessageResult_InvalidChannelName,
-        channel_name, message, *chat_user);
-
-      return true;
-    }
-
-    // Check if the message is valid
-    if (message.empty()) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidMessage);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(message);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_SendMessage_Complete, send_buffer);
-
-      // Trigger events
-      OnSendMessageCompleted(kChannelMessageResult_InvalidMessage,
-        channel_name, message, *chat_user);
-
-      return true;
-    }
-
-    if (message.size() > JCHAT_CHAT_MESSAGE_LENGTH) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_MessageTooLong);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(message);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_SendMessage_Complete, send_buffer);
-
-      // Trigger events
-      OnSendMessageCompleted(kChannelMessageResult_MessageTooLong,
-        channel_name, message, *chat_user);
-
-      return true;
-    }
-
-    // Check if the channel exists
-    std::shared_ptr<ChatChannel> chat_channel;
-    channels_mutex_.lock();
-    for (auto &channel : channels_) {
-      if (channel->Enabled && channel->Name == channel_name) {
-        chat_channel = channel;
-        break;
-      }
-    }
-    channels_mutex_.unlock();
-
-    if (!chat_channel) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(message);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_SendMessage_Complete, send_buffer);
-
-      // Trigger events
-      OnSendMessageCompleted(kChannelMessageResult_InvalidChannelName,
-        channel_name, message, *chat_user);
-
-      return true;
-    }
-
-    // Check if the user is in the channel
-    chat_channel->ClientsMutex.lock();
-    if (chat_channel->Clients.find(&client) == chat_channel->Clients.end()) {
-      chat_channel->ClientsMutex.unlock();
-
-      // Notify the client that they are not in the channel
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotInChannel);
-      send_buffer.WriteString(chat_channel->Name);
-      send_buffer.WriteString(message);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_SendMessage_Complete, send_buffer);
-
-      // Trigger events
-      OnSendMessageCompleted(kChannelMessageResult_NotInChannel,
-        chat_channel->Name, message, *chat_user);
-
-      return true;
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Send the message to all the clients
-    TypedBuffer clients_buffer = server_->CreateBuffer();
-    clients_buffer.WriteUInt16(kChannelMessageResult_MessageSent);
-    clients_buffer.WriteString(chat_channel->Name);
-    clients_buffer.WriteString(chat_user->Username);
-    clients_buffer.WriteString(chat_user->Hostname);
-    clients_buffer.WriteString(message);
-
-    chat_channel->ClientsMutex.lock();
-    for (auto &pair : chat_channel->Clients) {
-      if (pair.first != &client && pair.second->Enabled) {
-        server_->Send(pair.first, kComponentType_Channel,
-          kChannelMessageType_SendMessage, clients_buffer);
-      }
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Tell the client that the message was sent
-    TypedBuffer send_buffer = server_->CreateBuffer();
-    send_buffer.WriteUInt16(kChannelMessageResult_Ok);
-    send_buffer.WriteString(chat_channel->Name);
-    send_buffer.WriteString(message);
-    server_->Send(client, kComponentType_Channel,
-      kChannelMessageType_SendMessage_Complete, send_buffer);
-
-    // Trigger events
-    OnSendMessageCompleted(kChannelMessageResult_Ok, chat_channel->Name,
-      message, *chat_user);
-    OnChannelMessage(*chat_channel, *chat_user, message);
-
-    return true;
-  } else if (message_type == kChannelMessageType_OpUser) {
-    // TODO: Implement
-    return false;
-  } else if (message_type == kChannelMessageType_DeopUser) {
-    // TODO: Implement
-    return false;
-  } else if (message_type == kChannelMessageType_KickUser) {
-    std::string channel_name;
-    if (!buffer.ReadString(channel_name)) {
-      return false;
-    }
-
-    std::string target;
-    if (!buffer.ReadString(target)) {
-      return false;
-    }
-
-    // Get user component
-    std::shared_ptr<UserComponent> user_component;
-    if (!server_->GetComponent(kComponentType_User, user_component)) {
-      // Internal error, disconnect client
-      return false;
-    }
-
-    // Get the chat client
-    std::shared_ptr<ChatUser> chat_user;
-    if (!user_component->GetChatUser(client, chat_user)) {
-      // Internal error, disconnect client
-      return false;
-    }
-
-    // Check if the user is logged in
-    if (!chat_user->Identified) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotIdentified);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_KickUser_Complete, send_buffer);
-
-      // Trigger events
-      OnKickUserCompleted(kChannelMessageResult_NotIdentified, channel_name,
-        target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the channel name is valid
-    if (channel_name.empty() || channel_name[0] != '#') {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_KickUser_Complete, send_buffer);
-
-      // Trigger events
-      OnKickUserCompleted(kChannelMessageResult_InvalidChannelName,
-        channel_name, target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the target is valid
-    if (target.empty() || String::Contains(target, "#")) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidUsername);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_KickUser_Complete, send_buffer);
-
-      // Trigger events
-      OnKickUserCompleted(kChannelMessageResult_InvalidUsername,
-        channel_name, target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the channel exists
-    std::shared_ptr<ChatChannel> chat_channel;
-    channels_mutex_.lock();
-    for (auto &channel : channels_) {
-      if (channel->Enabled && channel->Name == channel_name) {
-        chat_channel = channel;
-        break;
-      }
-    }
-    channels_mutex_.unlock();
-
-    if (!chat_channel) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_KickUser_Complete, send_buffer);
-
-      // Trigger events
-      OnKickUserCompleted(kChannelMessageResult_InvalidChannelName,
-        channel_name, target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the user is in the channel
-    chat_channel->ClientsMutex.lock();
-    if (chat_channel->Clients.find(&client) == chat_channel->Clients.end()) {
-      chat_channel->ClientsMutex.unlock();
-
-      // Notify the client that they are not in the channel
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotInChannel);
-      send_buffer.WriteString(chat_channel->Name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_KickUser_Complete, send_buffer);
-
-      // Trigger events
-      OnKickUserCompleted(kChannelMessageResult_NotInChannel, chat_channel->Name,
-        target, *chat_user);
-
-      return true;
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Check if the user has permissions
-    chat_channel->OperatorsMutex.lock();
-    if (chat_channel->Operators.find(&client)
-      == chat_channel->Operators.end()) {
-      chat_channel->OperatorsMutex.unlock();
-
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotPermitted);
-      send_buffer.WriteString(chat_channel->Name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_KickUser_Complete, send_buffer);
-
-      // Trigger events
-      OnKickUserCompleted(kChannelMessageResult_NotPermitted,
-        chat_channel->Name, target, *chat_user);
-
-      return true;
-    }
-    chat_channel->OperatorsMutex.unlock();
-
-    // Check if the user is trying to kick themself
-    if (target == chat_user->Username) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_CannotKickSelf);
-      send_buffer.WriteString(chat_channel->Name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_KickUser_Complete, send_buffer);
-
-      // Trigger events
-      OnKickUserCompleted(kChannelMessageResult_CannotKickSelf,
-        chat_channel->Name, target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the target is in the channel
-    RemoteChatClient *kick_user_key = 0;
-    std::shared_ptr<ChatUser> kick_user;
-    chat_channel->ClientsMutex.lock();
-    for (auto pair : chat_channel->Clients) {
-      if (pair.second->Username == target) {
-        kick_user_key = pair.first;
-        kick_user = pair.second;
-        break;
-      }
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Notify other clients
-    TypedBuffer clients_buffer = server_->CreateBuffer();
-    clients_buffer.WriteUInt16(kChannelMessageResult_UserKicked);
-    clients_buffer.WriteString(chat_channel->Name);
-    clients_buffer.WriteString(kick_user->Username);
-    clients_buffer.WriteString(kick_user->Hostname);
-
-    chat_channel->ClientsMutex.lock();
-    for (auto &pair : chat_channel->Clients) {
-      if (pair.first != &client && pair.second->Enabled) {
-        server_->Send(pair.first, kComponentType_Channel,
-          kChannelMessageType_KickUser, clients_buffer);
-      }
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Tell the client that the user was banned
-    TypedBuffer send_buffer = server_->CreateBuffer();
-    send_buffer.WriteUInt16(kChannelMessageResult_Ok);
-    send_buffer.WriteString(chat_channel->Name);
-    send_buffer.WriteString(target);
-    send_buffer.WriteString(kick_user->Username);
-    send_buffer.WriteString(kick_user->Hostname);
-    server_->Send(client, kComponentType_Channel,
-      kChannelMessageType_KickUser_Complete, send_buffer);
-
-    // Remove the client from channel client lists
-    chat_channel->OperatorsMutex.lock();
-    if (chat_channel->Operators.find(kick_user_key)
-      != chat_channel->Operators.end()) {
-      chat_channel->Operators.erase(kick_user_key);
-    }
-    chat_channel->OperatorsMutex.unlock();
-
-    chat_channel->ClientsMutex.lock();
-    if (chat_channel->Clients.find(kick_user_key)
-      != chat_channel->Clients.end()) {
-      chat_channel->Clients.erase(kick_user_key);
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Trigger events
-    OnKickUserCompleted(kChannelMessageResult_Ok, chat_channel->Name,
-      target, *chat_user);
-    OnChannelUserKicked(*chat_channel, *kick_user);
-
-    return true;
-  } else if (message_type == kChannelMessageType_BanUser) {
-    std::string channel_name;
-    if (!buffer.ReadString(channel_name)) {
-      return false;
-    }
-
-    std::string target;
-    if (!buffer.ReadString(target)) {
-      return false;
-    }
-
-    // Get user component
-    std::shared_ptr<UserComponent> user_component;
-    if (!server_->GetComponent(kComponentType_User, user_component)) {
-      // Internal error, disconnect client
-      return false;
-    }
-
-    // Get the chat client
-    std::shared_ptr<ChatUser> chat_user;
-    if (!user_component->GetChatUser(client, chat_user)) {
-      // Internal error, disconnect client
-      return false;
-    }
-
-    // Check if the user is logged in
-    if (!chat_user->Identified) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotIdentified);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_BanUser_Complete, send_buffer);
-
-      // Trigger events
-      OnBanUserCompleted(kChannelMessageResult_NotIdentified, channel_name,
-        target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the channel name is valid
-    if (channel_name.empty() || channel_name[0] != '#') {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_BanUser_Complete, send_buffer);
-
-      // Trigger events
-      OnBanUserCompleted(kChannelMessageResult_InvalidChannelName,
-        channel_name, target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the target is valid
-    if (target.empty() || String::Contains(target, "#")) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidUsername);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_BanUser_Complete, send_buffer);
-
-      // Trigger events
-      OnBanUserCompleted(kChannelMessageResult_InvalidUsername,
-        channel_name, target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the channel exists
-    std::shared_ptr<ChatChannel> chat_channel;
-    channels_mutex_.lock();
-    for (auto &channel : channels_) {
-      if (channel->Enabled && channel->Name == channel_name) {
-        chat_channel = channel;
-        break;
-      }
-    }
-    channels_mutex_.unlock();
-
-    if (!chat_channel) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_BanUser_Complete, send_buffer);
-
-      // Trigger events
-      OnBanUserCompleted(kChannelMessageResult_InvalidChannelName,
-        channel_name, target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the user is in the channel
-    chat_channel->ClientsMutex.lock();
-    if (chat_channel->Clients.find(&client) == chat_channel->Clients.end()) {
-      chat_channel->ClientsMutex.unlock();
-
-      // Notify the client that they are not in the channel
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotInChannel);
-      send_buffer.WriteString(chat_channel->Name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_BanUser_Complete, send_buffer);
-
-      // Trigger events
-      OnBanUserCompleted(kChannelMessageResult_NotInChannel, chat_channel->Name,
-        target, *chat_user);
-
-      return true;
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Check if the user has permissions
-    chat_channel->OperatorsMutex.lock();
-    if (chat_channel->Operators.find(&client)
-      == chat_channel->Operators.end()) {
-      chat_channel->OperatorsMutex.unlock();
-
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_NotPermitted);
-      send_buffer.WriteString(chat_channel->Name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_BanUser_Complete, send_buffer);
-
-      // Trigger events
-      OnBanUserCompleted(kChannelMessageResult_NotPermitted,
-        chat_channel->Name, target, *chat_user);
-
-      return true;
-    }
-    chat_channel->OperatorsMutex.unlock();
-
-    // Check if the user is trying to ban themself
-    if (target == chat_user->Username) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_CannotBanSelf);
-      send_buffer.WriteString(chat_channel->Name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_BanUser_Complete, send_buffer);
-
-      // Trigger events
-      OnBanUserCompleted(kChannelMessageResult_CannotBanSelf,
-        chat_channel->Name, target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the target is in the channel
-    RemoteChatClient *ban_user_key = 0;
-    std::shared_ptr<ChatUser> ban_user;
-    std::string target_string;
-    chat_channel->ClientsMutex.lock();
-    for (auto pair : chat_channel->Clients) {
-      if (pair.second->Username == target) {
-        ban_user_key = pair.first;
-        ban_user = pair.second;
-        target_string = pair.second->Username + "@" + pair.second->Hostname;
-        break;
-      }
-    }
-    chat_channel->ClientsMutex.unlock();
-    if (target_string.empty()) {
-      TypedBuffer send_buffer = server_->CreateBuffer();
-      send_buffer.WriteUInt16(kChannelMessageResult_InvalidUsername);
-      send_buffer.WriteString(channel_name);
-      send_buffer.WriteString(target);
-      server_->Send(client, kComponentType_Channel,
-        kChannelMessageType_BanUser_Complete, send_buffer);
-
-      // Trigger events
-      OnBanUserCompleted(kChannelMessageResult_InvalidUsername,
-        channel_name, target, *chat_user);
-
-      return true;
-    }
-
-    // Check if the target is already banned
-    chat_channel->BannedUsersMutex.lock();
-    for (auto &banned_user : chat_channel->BannedUsers) {
-      if (banned_user == target) {
-        chat_channel->BannedUsersMutex.unlock();
-
-        TypedBuffer send_buffer = server_->CreateBuffer();
-        send_buffer.WriteUInt16(kChannelMessageResult_AlreadyBanned);
-        send_buffer.WriteString(chat_channel->Name);
-        send_buffer.WriteString(target);
-        server_->Send(client, kComponentType_Channel,
-          kChannelMessageType_BanUser_Complete, send_buffer);
-
-        // Trigger events
-        OnBanUserCompleted(kChannelMessageResult_AlreadyBanned,
-          chat_channel->Name, target, *chat_user);
-
-        return true;
-      }
-    }
-
-    // Ban the user
-    chat_channel->BannedUsers.push_back(target_string);
-    chat_channel->BannedUsersMutex.unlock();
-
-    // Notify other clients
-    TypedBuffer clients_buffer = server_->CreateBuffer();
-    clients_buffer.WriteUInt16(kChannelMessageResult_UserBanned);
-    clients_buffer.WriteString(chat_channel->Name);
-    clients_buffer.WriteString(ban_user->Username);
-    clients_buffer.WriteString(ban_user->Hostname);
-
-    chat_channel->ClientsMutex.lock();
-    for (auto &pair : chat_channel->Clients) {
-      if (pair.first != &client && pair.second->Enabled) {
-        server_->Send(pair.first, kComponentType_Channel,
-          kChannelMessageType_BanUser, clients_buffer);
-      }
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Tell the client that the user was banned
-    TypedBuffer send_buffer = server_->CreateBuffer();
-    send_buffer.WriteUInt16(kChannelMessageResult_Ok);
-    send_buffer.WriteString(chat_channel->Name);
-    send_buffer.WriteString(target);
-    send_buffer.WriteString(ban_user->Username);
-    send_buffer.WriteString(ban_user->Hostname);
-    server_->Send(client, kComponentType_Channel,
-      kChannelMessageType_BanUser_Complete, send_buffer);
-
-    // Remove the client from channel client lists
-    chat_channel->OperatorsMutex.lock();
-    if (chat_channel->Operators.find(ban_user_key)
-      != chat_channel->Operators.end()) {
-      chat_channel->Operators.erase(ban_user_key);
-    }
-    chat_channel->OperatorsMutex.unlock();
-
-    chat_channel->ClientsMutex.lock();
-    if (chat_channel->Clients.find(ban_user_key)
-      != chat_channel->Clients.end()) {
-      chat_channel->Clients.erase(ban_user_key);
-    }
-    chat_channel->ClientsMutex.unlock();
-
-    // Trigger events
-    OnBanUserCompleted(kChannelMessageResult_Ok, chat_channel->Name,
-      target, *chat_user);
-    OnChannelUserBanned(*chat_channel, *ban_user);
-
-    return true;
-  } else if (message_type == kChannelMessageType_UnbanUser) {
-    // TODO: Implement
-    return false;
-  }
-
-  return false;
-}
-}
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#include "components/channel_component.h"
+#include "components/user_component.h"
+#include "chat_server.h"
+#include "protocol/protocol.h"
+#include "protocol/components/channel_message_type.h"
+#include "string.hpp"
+#include <algorithm>
+
+namespace jchat {
+ChannelComponent::ChannelComponent() {
+}
+
+ChannelComponent::~ChannelComponent() {
+}
+
+bool ChannelComponent::Initialize(ChatServer &server) {
+  server_ = &server;
+  return true;
+}
+
+bool ChannelComponent::Shutdown() {
+  server_ = 0;
+
+  // Remove channels
+  clearChannels();
+
+  return true;
+}
+
+bool ChannelComponent::OnStart() {
+  return true;
+}
+
+bool ChannelComponent::OnStop() {
+  // Remove channels
+  clearChannels();
+
+  return true;
+}
+
+void ChannelComponent::OnClientConnected(RemoteChatClient &client) {
+  // Keep track of the channels the client joins
+  client.SetState(kComponentType_Channel,
+    std::make_shared<ChannelMemberships>());
+}
+
+void ChannelComponent::OnClientDisconnected(RemoteChatClient &client) {
+  ChannelMemberships *memberships = client.GetState<ChannelMemberships>(
+    kComponentType_Channel);
+  if (memberships == nullptr) {
+    return;
+  }
+
+  // Close the memberships so that joins still in flight are dropped, then ask
+  // the channels which the client is in to drop it and notify their clients
+  std::vector<std::shared_ptr<ChatChannel>> channels;
+  {
+    std::lock_guard<std::mutex> memberships_lock(memberships->Mutex);
+    memberships->Closed = true;
+    channels.swap(memberships->Channels);
+  }
+  ConnectionHandle handle = client.Handle;
+  for (auto &channel : channels) {
+    channel->Mailbox->Post([this, channel, handle]() {
+      removeChannelClient(channel, handle);
+    });
+  }
+}
+
+ComponentType ChannelComponent::GetType() {
+  return kComponentType_Channel;
+}
+
+bool ChannelComponent::Handle(RemoteChatClient &client, uint16_t message_type,
+  TypedBuffer &buffer) {
+  if (message_type == kChannelMessageType_JoinChannel) {
+    std::string channel_name;
+    if (!buffer.ReadString(channel_name)) {
+      return false;
+    }
+
+    // Get the chat user
+    std::shared_ptr<ChatUser> chat_user;
+    if (!client.GetState(kComponentType_User, chat_user)) {
+      // Internal error, disconnect client
+      return false;
+    }
+
+    // Check if the user is logged in
+    if (!chat_user->Identified) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_NotIdentified);
+	    send_buffer.WriteString(channel_name);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_JoinChannel_Complete, send_buffer);
+
+      // Trigger events
+      OnJoinCompleted(kChannelMessageResult_NotIdentified, channel_name,
+        *chat_user);
+
+      return true;
+    }
+
+    // Check if the channel name is valid
+    if (channel_name.empty() || channel_name[0] != '#') {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+      send_buffer.WriteString(channel_name);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_JoinChannel_Complete, send_buffer);
+
+      // Trigger events
+      OnJoinCompleted(kChannelMessageResult_InvalidChannelName, channel_name,
+        *chat_user);
+
+      return true;
+    }
+
+    // Check if the channel exists
+    std::shared_ptr<ChatChannel> chat_channel;
+    if (!getChannel(channel_name, chat_channel)) {
+      // Check if the channel name is too long
+      if (channel_name.size() - 1 > JCHAT_CHAT_CHANNEL_NAME_LENGTH) {
+        TypedBuffer send_buffer = server_->CreateBuffer();
+        send_buffer.WriteUInt16(kChannelMessageResult_ChannelNameTooLong);
+        send_buffer.WriteString(channel_name);
+        server_->Send(client, kComponentType_User,
+          kChannelMessageType_JoinChannel_Complete, send_buffer);
+
+        // Trigger events
+        OnJoinCompleted(kChannelMessageResult_ChannelNameTooLong, channel_name,
+          *chat_user);
+
+        return true;
+      }
+
+      // Create the channel, the user creates it by being the first to join
+      chat_channel = getOrCreateChannel(channel_name);
+    }
+
+    // Get the client's memberships
+    std::shared_ptr<ChannelMemberships> memberships;
+    if (!client.GetState(kComponentType_Channel, memberships)) {
+      // Internal error, disconnect client
+      return false;
+    }
+
+    // Join the channel
+    beginJoin(*memberships);
+    ConnectionHandle handle = client.Handle;
+    chat_channel->Mailbox->Post([this, chat_channel, handle, chat_user,
+      memberships]() {
+      joinChannel(chat_channel, handle, chat_user, memberships);
+    });
+
+    return true;
+  } else if (message_type == kChannelMessageType_LeaveChannel) {
+    std::string channel_name;
+    if (!buffer.ReadString(channel_name)) {
+      return false;
+    }
+
+    // Get the chat user
+    std::shared_ptr<ChatUser> chat_user;
+    if (!client.GetState(kComponentType_User, chat_user)) {
+      // Internal error, disconnect client
+      return false;
+    }
+
+    // Check if the user is logged in
+    if (!chat_user->Identified) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_NotIdentified);
+      send_buffer.WriteString(channel_name);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_LeaveChannel_Complete, send_buffer);
+
+      // Trigger events
+      OnLeaveCompleted(kChannelMessageResult_NotIdentified, channel_name,
+        *chat_user);
+
+      return true;
+    }
+
+    // Check if the channel name is valid
+    if (channel_name.empty() || channel_name[0] != '#') {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+      send_buffer.WriteString(channel_name);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_LeaveChannel_Complete, send_buffer);
+
+      // Trigger events
+      OnLeaveCompleted(kChannelMessageResult_InvalidChannelName, channel_name,
+        *chat_user);
+
+      return true;
+    }
+
+    // Check if the channel exists
+    std::shared_ptr<ChatChannel> chat_channel;
+    if (!getChannel(channel_name, chat_channel)) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+      send_buffer.WriteString(channel_name);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_LeaveChannel_Complete, send_buffer);
+
+      // Trigger events
+      OnLeaveCompleted(kChannelMessageResult_InvalidChannelName, channel_name,
+        *chat_user);
+
+      return true;
+    }
+
+    // Leave the channel
+    ConnectionHandle handle = client.Handle;
+    chat_channel->Mailbox->Post([this, chat_channel, handle, chat_user]() {
+      leaveChannel(chat_channel, handle, chat_user);
+    });
+
+    return true;
+  } else if (message_type == kChannelMessageType_SendMessage) {
+    std::string channel_name;
+    if (!buffer.ReadString(channel_name)) {
+      return false;
+    }
+
+    std::string message;
+    if (!buffer.ReadString(message)) {
+      return false;
+    }
+
+    // Get the chat user
+    std::shared_ptr<ChatUser> chat_user;
+    if (!client.GetState(kComponentType_User, chat_user)) {
+      // Internal error, disconnect client
+      return false;
+    }
+
+    // Check if the user is logged in
+    if (!chat_user->Identified) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_NotIdentified);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(message);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_SendMessage_Complete, send_buffer);
+
+      // Trigger events
+      OnSendMessageCompleted(kChannelMessageResult_NotIdentified, channel_name,
+        message, *chat_user);
+
+      return true;
+    }
+
+    // Check if the channel name is valid
+    if (channel_name.empty() || channel_name[0] != '#') {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(message);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_SendMessage_Complete, send_buffer);
+
+      // Trigger events
+      OnSendMessageCompleted(kChannelMessageResult_InvalidChannelName,
+        channel_name, message, *chat_user);
+
+      return true;
+    }
+
+    // Check if the message is valid
+    if (message.empty()) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidMessage);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(message);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_SendMessage_Complete, send_buffer);
+
+      // Trigger events
+      OnSendMessageCompleted(kChannelMessageResult_InvalidMessage,
+        channel_name, message, *chat_user);
+
+      return true;
+    }
+
+    if (message.size() > JCHAT_CHAT_MESSAGE_LENGTH) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_MessageTooLong);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(message);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_SendMessage_Complete, send_buffer);
+
+      // Trigger events
+      OnSendMessageCompleted(kChannelMessageResult_MessageTooLong,
+        channel_name, message, *chat_user);
+
+      return true;
+    }
+
+    // Check if the channel exists
+    std::shared_ptr<ChatChannel> chat_channel;
+    if (!getChannel(channel_name, chat_channel)) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(message);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_SendMessage_Complete, send_buffer);
+
+      // Trigger events
+      OnSendMessageCompleted(kChannelMessageResult_InvalidChannelName,
+        channel_name, message, *chat_user);
+
+      return true;
+    }
+
+    // Check if the user is in the channel, the mailbox checks again since
+    // the user may leave before it gets to the message
+    std::shared_ptr<ChannelMemberships> memberships;
+    if (!client.GetState(kComponentType_Channel, memberships)) {
+      // Internal error, disconnect client
+      return false;
+    }
+    if (!mayBeInChannel(*memberships, chat_channel)) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_NotInChannel);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(message);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_SendMessage_Complete, send_buffer);
+
+      // Trigger events
+      OnSendMessageCompleted(kChannelMessageResult_NotInChannel,
+        channel_name, message, *chat_user);
+
+      return true;
+    }
+
+    // Check if the client or its address is sending too fast, only messages
+    // which can be delivered count
+    if (!server_->GetRateLimiter().TakeClient(client, message.size())) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_RateLimited);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(message);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_SendMessage_Complete, send_buffer);
+
+      // Trigger events
+      OnSendMessageCompleted(kChannelMessageResult_RateLimited,
+        channel_name, message, *chat_user);
+
+      return true;
+    }
+
+    // Send the message to the channel
+    ConnectionHandle handle = client.Handle;
+    chat_channel->Mailbox->Post([this, chat_channel, handle, chat_user,
+      message]() {
+      sendChannelMessage(chat_channel, handle, chat_user, message);
+    });
+
+    return true;
+  } else if (message_type == kChannelMessageType_OpUser) {
+    // TODO: Implement
+    return false;
+  } else if (message_type == kChannelMessageType_DeopUser) {
+    // TODO: Implement
+    return false;
+  } else if (message_type == kChannelMessageType_KickUser) {
+    std::string channel_name;
+    if (!buffer.ReadString(channel_name)) {
+      return false;
+    }
+
+    std::string target;
+    if (!buffer.ReadString(target)) {
+      return false;
+    }
+
+    // Get the chat user
+    std::shared_ptr<ChatUser> chat_user;
+    if (!client.GetState(kComponentType_User, chat_user)) {
+      // Internal error, disconnect client
+      return false;
+    }
+
+    // Check if the user is logged in
+    if (!chat_user->Identified) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_NotIdentified);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(target);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_KickUser_Complete, send_buffer);
+
+      // Trigger events
+      OnKickUserCompleted(kChannelMessageResult_NotIdentified, channel_name,
+        target, *chat_user);
+
+      return true;
+    }
+
+    // Check if the channel name is valid
+    if (channel_name.empty() || channel_name[0] != '#') {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(target);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_KickUser_Complete, send_buffer);
+
+      // Trigger events
+      OnKickUserCompleted(kChannelMessageResult_InvalidChannelName,
+        channel_name, target, *chat_user);
+
+      return true;
+    }
+
+    // Check if the target is valid
+    if (target.empty() || String::Contains(target, "#")) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidUsername);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(target);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_KickUser_Complete, send_buffer);
+
+      // Trigger events
+      OnKickUserCompleted(kChannelMessageResult_InvalidUsername,
+        channel_name, target, *chat_user);
+
+      return true;
+    }
+
+    // Check if the channel exists
+    std::shared_ptr<ChatChannel> chat_channel;
+    if (!getChannel(channel_name, chat_channel)) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(target);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_KickUser_Complete, send_buffer);
+
+      // Trigger events
+      OnKickUserCompleted(kChannelMessageResult_InvalidChannelName,
+        channel_name, target, *chat_user);
+
+      return true;
+    }
+
+    // Kick the user from the channel
+    ConnectionHandle handle = client.Handle;
+    chat_channel->Mailbox->Post([this, chat_channel, handle, chat_user,
+      target]() {
+      kickChannelUser(chat_channel, handle, chat_user, target);
+    });
+
+    return true;
+  } else if (message_type == kChannelMessageType_BanUser) {
+    std::string channel_name;
+    if (!buffer.ReadString(channel_name)) {
+      return false;
+    }
+
+    std::string target;
+    if (!buffer.ReadString(target)) {
+      return false;
+    }
+
+    // Get the chat user
+    std::shared_ptr<ChatUser> chat_user;
+    if (!client.GetState(kComponentType_User, chat_user)) {
+      // Internal error, disconnect client
+      return false;
+    }
+
+    // Check if the user is logged in
+    if (!chat_user->Identified) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_NotIdentified);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(target);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_BanUser_Complete, send_buffer);
+
+      // Trigger events
+      OnBanUserCompleted(kChannelMessageResult_NotIdentified, channel_name,
+        target, *chat_user);
+
+      return true;
+    }
+
+    // Check if the channel name is valid
+    if (channel_name.empty() || channel_name[0] != '#') {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(target);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_BanUser_Complete, send_buffer);
+
+      // Trigger events
+      OnBanUserCompleted(kChannelMessageResult_InvalidChannelName,
+        channel_name, target, *chat_user);
+
+      return true;
+    }
+
+    // Check if the target is valid
+    if (target.empty() || String::Contains(target, "#")) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidUsername);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(target);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_BanUser_Complete, send_buffer);
+
+      // Trigger events
+      OnBanUserCompleted(kChannelMessageResult_InvalidUsername,
+        channel_name, target, *chat_user);
+
+      return true;
+    }
+
+    // Check if the channel exists
+    std::shared_ptr<ChatChannel> chat_channel;
+    if (!getChannel(channel_name, chat_channel)) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+      send_buffer.WriteString(channel_name);
+      send_buffer.WriteString(target);
+      server_->Send(client, kComponentType_Channel,
+        kChannelMessageType_BanUser_Complete, send_buffer);
+
+      // Trigger events
+      OnBanUserCompleted(kChannelMessageResult_InvalidChannelName,
+        channel_name, target, *chat_user);
+
+      return true;
+    }
+
+    // Ban the user from the channel
+    ConnectionHandle handle = client.Handle;
+    chat_channel->Mailbox->Post([this, chat_channel, handle, chat_user,
+      target]() {
+      banChannelUser(chat_channel, handle, chat_user, target);
+    });
+
+    return true;
+  } else if (message_type == kChannelMessageType_UnbanUser) {
+    // TODO: Implement
+    return false;
+  }
+
+  return false;
+}
+
+RcuPointer<ChannelComponent::ChannelMap> &ChannelComponent::getChannels(
+  const std::string &channel_name) {
+  size_t hash = std::hash<std::string>()(channel_name);
+  return channels_[hash % JCHAT_CHANNEL_INDEX_SHARDS];
+}
+
+void ChannelComponent::clearChannels() {
+  for (auto &channels : channels_) {
+    channels.Publish(ChannelMap());
+  }
+}
+
+bool ChannelComponent::getChannel(const std::string &channel_name,
+  std::shared_ptr<ChatChannel> &out_channel) {
+  RcuReadLock read_lock;
+  const ChannelMap &channels = *getChannels(channel_name).Read();
+  auto it = channels.find(channel_name);
+  if (it == channels.end()) {
+    return false;
+  }
+  out_channel = it->second;
+  return true;
+}
+
+std::shared_ptr<ChatChannel> ChannelComponent::getOrCreateChannel(
+  const std::string &channel_name) {
+  std::shared_ptr<ChatChannel> chat_channel;
+  getChannels(channel_name).Update([this, &channel_name, &chat_channel](
+    ChannelMap &channels) {
+    auto it = channels.find(channel_name);
+    if (it != channels.end()) {
+      chat_channel = it->second;
+      return false;
+    }
+
+    // The channel starts out empty, the first client to join it becomes its
+    // operator
+    chat_channel = std::make_shared<ChatChannel>();
+    chat_channel->Enabled = true;
+    chat_channel->Name = channel_name;
+    chat_channel->Mailbox = std::make_shared<Strand>(server_->GetExecutor());
+    channels[channel_name] = chat_channel;
+    return true;
+  });
+  return chat_channel;
+}
+
+void ChannelComponent::disableChannel(ChatChannel &channel) {
+  channel.Operators.Clear();
+  channel.Enabled = false;
+
+  // Clients which looked the channel up before it was removed may still post
+  // to it, the actor functions check Enabled for that
+  getChannels(channel.Name).Update([&channel](ChannelMap &channels) {
+    auto it = channels.find(channel.Name);
+    if (it == channels.end() || it->second.get() != &channel) {
+      return false;
+    }
+    channels.erase(it);
+    return true;
+  });
+}
+
+void ChannelComponent::beginJoin(ChannelMemberships &memberships) {
+  std::lock_guard<std::mutex> memberships_lock(memberships.Mutex);
+  memberships.PendingJoins++;
+}
+
+void ChannelComponent::endJoin(ChannelMemberships &memberships) {
+  std::lock_guard<std::mutex> memberships_lock(memberships.Mutex);
+  memberships.PendingJoins--;
+}
+
+bool ChannelComponent::mayBeInChannel(ChannelMemberships &memberships,
+  const std::shared_ptr<ChatChannel> &channel) {
+  std::lock_guard<std::mutex> memberships_lock(memberships.Mutex);
+  if (memberships.PendingJoins != 0) {
+    return true;
+  }
+  auto &channels = memberships.Channels;
+  return std::find(channels.begin(), channels.end(), channel)
+    != channels.end();
+}
+
+bool ChannelComponent::addChannelClient(std::shared_ptr<ChatChannel> channel,
+  ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user,
+  std::shared_ptr<ChannelMemberships> memberships) {
+  {
+    // End the join in the same step as adding the channel, so the client
+    // is never seen as neither joining nor in the channel
+    std::lock_guard<std::mutex> memberships_lock(memberships->Mutex);
+    memberships->PendingJoins--;
+    if (memberships->Closed) {
+      return false;
+    }
+    memberships->Channels.push_back(channel);
+  }
+
+  channel->Clients.Set(handle, chat_user);
+  channel->Memberships.Set(handle, memberships);
+
+  // Leave the name with the client which already has it
+  ChannelMember member = { handle, 0 };
+  auto it = channel->Members.emplace(String::ToLower(chat_user->Username),
+    member).first;
+  it->second.Count++;
+  return true;
+}
+
+void ChannelComponent::eraseChannelClient(
+  std::shared_ptr<ChatChannel> channel, ConnectionHandle handle) {
+  std::shared_ptr<ChatUser> *chat_user = channel->Clients.Find(handle);
+  if (chat_user == nullptr) {
+    return;
+  }
+
+  std::shared_ptr<ChannelMemberships> *memberships =
+    channel->Memberships.Find(handle);
+  if (memberships != nullptr) {
+    std::lock_guard<std::mutex> memberships_lock((*memberships)->Mutex);
+    auto &channels = (*memberships)->Channels;
+    auto channel_it = std::find(channels.begin(), channels.end(), channel);
+    if (channel_it != channels.end()) {
+      *channel_it = channels.back();
+      channels.pop_back();
+    }
+  }
+
+  std::string folded_username = String::ToLower((*chat_user)->Username);
+  auto it = channel->Members.find(folded_username);
+  if (it != channel->Members.end()) {
+    if (--it->second.Count == 0) {
+      channel->Members.erase(it);
+    } else if (it->second.Handle == handle) {
+      // Hand the name to another client which has it
+      for (auto &pair : channel->Clients) {
+        if (pair.first != handle
+          && String::ToLower(pair.second->Username) == folded_username) {
+          it->second.Handle = pair.first;
+          break;
+        }
+      }
+    }
+  }
+
+  channel->Clients.Remove(handle);
+  channel->Operators.Remove(handle);
+  channel->Memberships.Remove(handle);
+}
+
+void ChannelComponent::publishRecipients(ChatChannel &channel) {
+  std::vector<ConnectionHandle> recipients;
+  recipients.reserve(channel.Clients.GetSize());
+  for (auto &pair : channel.Clients) {
+    recipients.push_back(pair.first);
+  }
+  channel.Recipients.Publish(std::move(recipients));
+}
+
+void ChannelComponent::broadcast(ChatChannel &channel,
+  ConnectionHandle skip_handle, uint8_t message_type, TypedBuffer &buffer,
+  SendPriority priority) {
+  RcuReadLock read_lock;
+  server_->Broadcast(*channel.Recipients.Read(), kComponentType_Channel,
+    message_type, buffer, skip_handle, priority);
+}
+
+void ChannelComponent::joinChannel(std::shared_ptr<ChatChannel> channel,
+  ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user,
+  std::shared_ptr<ChannelMemberships> memberships) {
+  // The channel was closed after it was looked up, so join the channel which
+  // takes its place instead
+  if (!channel->Enabled) {
+    std::shared_ptr<ChatChannel> new_channel = getOrCreateChannel(
+      channel->Name);
+    new_channel->Mailbox->Post([this, new_channel, handle, chat_user,
+      memberships]() {
+      joinChannel(new_channel, handle, chat_user, memberships);
+    });
+    return;
+  }
+
+  if (channel->Clients.IsEmpty()) {
+    // Add the user to the new channel, unless it disconnected while the join
+    // was queued. Then the channel is closed again, since nobody is in it
+    if (!addChannelClient(channel, handle, chat_user, memberships)) {
+      disableChannel(*channel);
+      return;
+    }
+    channel->Operators.Set(handle, chat_user);
+    publishRecipients(*channel);
+
+    // Notify the client that the channel was created and that they are
+    // the operator operator and member of it
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_ChannelCreated);
+    send_buffer.WriteString(channel->Name);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_JoinChannel_Complete, send_buffer);
+
+    // Trigger the events
+    OnJoinCompleted(kChannelMessageResult_ChannelCreated, channel->Name,
+      *chat_user);
+
+    OnChannelCreated(*channel);
+    OnChannelJoined(*channel, *chat_user);
+
+    return;
+  }
+
+  // Check if the user is already in the channel
+  if (channel->Clients.Contains(handle)) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_AlreadyInChannel);
+    send_buffer.WriteString(channel->Name);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_JoinChannel_Complete, send_buffer);
+
+    // Trigger events
+    OnJoinCompleted(kChannelMessageResult_AlreadyInChannel, channel->Name,
+      *chat_user);
+
+    endJoin(*memberships);
+    return;
+  }
+
+  // Check if the user is banned
+  if (channel->BannedUsers.IsBanned(chat_user->Username,
+    chat_user->Hostname)) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_BannedFromChannel);
+    send_buffer.WriteString(channel->Name);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_JoinChannel_Complete, send_buffer);
+
+    // Trigger events
+    OnJoinCompleted(kChannelMessageResult_BannedFromChannel, channel->Name,
+      *chat_user);
+
+    endJoin(*memberships);
+    return;
+  }
+
+  // Add the user to the channel, unless it disconnected while the join was
+  // queued
+  if (!addChannelClient(channel, handle, chat_user, memberships)) {
+    return;
+  }
+  publishRecipients(*channel);
+
+  // Notify the client that it joined the channel and give it a list of
+  // current clients
+  TypedBuffer client_buffer = server_->CreateBuffer();
+  client_buffer.WriteUInt16(kChannelMessageResult_Ok); // Channel joined
+  client_buffer.WriteString(channel->Name);
+
+  size_t client_count = 0;
+  for (auto &pair : channel->Clients) {
+    if (pair.first != handle && pair.second->Enabled) {
+      client_count++;
+    }
+  }
+  client_buffer.WriteUInt64(client_count);
+  for (auto &pair : channel->Clients) {
+    if (pair.first != handle && pair.second->Enabled) {
+      client_buffer.WriteString(pair.second->Username);
+      client_buffer.WriteString(pair.second->Hostname);
+      client_buffer.WriteBoolean(
+        channel->Operators.Contains(pair.first));
+    }
+  }
+
+  client_buffer.WriteUInt64(channel->BannedUsers.GetSize());
+  for (auto &banned_user : channel->BannedUsers.GetBans()) {
+    client_buffer.WriteString(banned_user);
+  }
+
+  server_->Send(handle, kComponentType_Channel,
+    kChannelMessageType_JoinChannel_Complete, client_buffer);
+
+  // Notify all clients in the channel that the user has joined
+  TypedBuffer clients_buffer = server_->CreateBuffer();
+  clients_buffer.WriteUInt16(kChannelMessageResult_UserJoined);
+  clients_buffer.WriteString(channel->Name);
+  clients_buffer.WriteString(chat_user->Username);
+  clients_buffer.WriteString(chat_user->Hostname);
+
+  broadcast(*channel, handle, kChannelMessageType_JoinChannel, clients_buffer,
+    kSendPriority_Control);
+
+  // Trigger the events
+  OnJoinCompleted(kChannelMessageResult_Ok, channel->Name, *chat_user);
+  OnChannelJoined(*channel, *chat_user);
+}
+
+void ChannelComponent::leaveChannel(std::shared_ptr<ChatChannel> channel,
+  ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user) {
+  // Check if the channel still exists
+  if (!channel->Enabled) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+    send_buffer.WriteString(channel->Name);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_LeaveChannel_Complete, send_buffer);
+
+    // Trigger events
+    OnLeaveCompleted(kChannelMessageResult_InvalidChannelName, channel->Name,
+      *chat_user);
+
+    return;
+  }
+
+  // Check if the user is in the channel
+  if (!channel->Clients.Contains(handle)) {
+    // Notify the client that they are not in the channel
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_NotInChannel);
+    send_buffer.WriteString(channel->Name);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_LeaveChannel_Complete, send_buffer);
+
+    // Trigger events
+    OnLeaveCompleted(kChannelMessageResult_NotInChannel, channel->Name,
+      *chat_user);
+
+    return;
+  }
+
+  // Notify all clients in that channel that the client left
+  TypedBuffer clients_buffer = server_->CreateBuffer();
+  clients_buffer.WriteUInt16(kChannelMessageResult_UserLeft);
+  clients_buffer.WriteString(channel->Name);
+  clients_buffer.WriteString(chat_user->Username);
+  clients_buffer.WriteString(chat_user->Hostname);
+
+  broadcast(*channel, handle, kChannelMessageType_LeaveChannel, clients_buffer,
+    kSendPriority_Control);
+
+  // Notify the client that they left the channel
+  TypedBuffer send_buffer = server_->CreateBuffer();
+  send_buffer.WriteUInt16(kChannelMessageResult_Ok);
+  send_buffer.WriteString(channel->Name);
+  server_->Send(handle, kComponentType_Channel,
+    kChannelMessageType_LeaveChannel_Complete, send_buffer);
+
+  // Trigger events
+  OnLeaveCompleted(kChannelMessageResult_Ok, channel->Name, *chat_user);
+  OnChannelLeft(*channel, *chat_user);
+
+  // Remove the client from the clients and operators lists
+  eraseChannelClient(channel, handle);
+  publishRecipients(*channel);
+
+  // If there was nobody in the channel delete it
+  if (channel->Clients.IsEmpty()) {
+    disableChannel(*channel);
+  }
+}
+
+void ChannelComponent::sendChannelMessage(
+  std::shared_ptr<ChatChannel> channel, ConnectionHandle handle,
+  std::shared_ptr<ChatUser> chat_user, std::string message) {
+  // Check if the channel still exists
+  if (!channel->Enabled) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(message);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_SendMessage_Complete, send_buffer);
+
+    // Trigger events
+    OnSendMessageCompleted(kChannelMessageResult_InvalidChannelName,
+      channel->Name, message, *chat_user);
+
+    return;
+  }
+
+  // Check if the user is in the channel
+  if (!channel->Clients.Contains(handle)) {
+    // Notify the client that they are not in the channel
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_NotInChannel);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(message);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_SendMessage_Complete, send_buffer);
+
+    // Trigger events
+    OnSendMessageCompleted(kChannelMessageResult_NotInChannel,
+      channel->Name, message, *chat_user);
+
+    return;
+  }
+
+  // Check if the channel as a whole is too busy
+  if (!server_->GetRateLimiter().TakeChannel(*channel, message.size())) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_RateLimited);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(message);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_SendMessage_Complete, send_buffer);
+
+    // Trigger events
+    OnSendMessageCompleted(kChannelMessageResult_RateLimited,
+      channel->Name, message, *chat_user);
+
+    return;
+  }
+
+  // Send the message to all the clients
+  TypedBuffer clients_buffer = server_->CreateBuffer();
+  clients_buffer.WriteUInt16(kChannelMessageResult_MessageSent);
+  clients_buffer.WriteString(channel->Name);
+  clients_buffer.WriteString(chat_user->Username);
+  clients_buffer.WriteString(chat_user->Hostname);
+  clients_buffer.WriteString(message);
+
+  broadcast(*channel, handle, kChannelMessageType_SendMessage, clients_buffer,
+    kSendPriority_Bulk);
+
+  // Tell the client that the message was sent
+  TypedBuffer send_buffer = server_->CreateBuffer();
+  send_buffer.WriteUInt16(kChannelMessageResult_Ok);
+  send_buffer.WriteString(channel->Name);
+  send_buffer.WriteString(message);
+  server_->Send(handle, kComponentType_Channel,
+    kChannelMessageType_SendMessage_Complete, send_buffer);
+
+  // Trigger events
+  OnSendMessageCompleted(kChannelMessageResult_Ok, channel->Name, message,
+    *chat_user);
+  OnChannelMessage(*channel, *chat_user, message);
+}
+
+void ChannelComponent::kickChannelUser(std::shared_ptr<ChatChannel> channel,
+  ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user,
+  std::string target) {
+  // Check if the channel still exists
+  if (!channel->Enabled) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_KickUser_Complete, send_buffer);
+
+    // Trigger events
+    OnKickUserCompleted(kChannelMessageResult_InvalidChannelName,
+      channel->Name, target, *chat_user);
+
+    return;
+  }
+
+  // Check if the user is in the channel
+  if (!channel->Clients.Contains(handle)) {
+    // Notify the client that they are not in the channel
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_NotInChannel);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_KickUser_Complete, send_buffer);
+
+    // Trigger events
+    OnKickUserCompleted(kChannelMessageResult_NotInChannel, channel->Name,
+      target, *chat_user);
+
+    return;
+  }
+
+  // Check if the user has permissions
+  if (!channel->Operators.Contains(handle)) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_NotPermitted);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_KickUser_Complete, send_buffer);
+
+    // Trigger events
+    OnKickUserCompleted(kChannelMessageResult_NotPermitted, channel->Name,
+      target, *chat_user);
+
+    return;
+  }
+
+  // Check if the user is trying to kick themself
+  std::string folded_target = String::ToLower(target);
+  if (folded_target == String::ToLower(chat_user->Username)) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_CannotKickSelf);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_KickUser_Complete, send_buffer);
+
+    // Trigger events
+    OnKickUserCompleted(kChannelMessageResult_CannotKickSelf, channel->Name,
+      target, *chat_user);
+
+    return;
+  }
+
+  // Check if the target is in the channel
+  ConnectionHandle kick_user_key;
+  std::shared_ptr<ChatUser> kick_user;
+  auto member = channel->Members.find(folded_target);
+  if (member != channel->Members.end()) {
+    kick_user_key = member->second.Handle;
+    kick_user = *channel->Clients.Find(kick_user_key);
+  }
+  if (!kick_user) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_InvalidUsername);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_KickUser_Complete, send_buffer);
+
+    // Trigger events
+    OnKickUserCompleted(kChannelMessageResult_InvalidUsername, channel->Name,
+      target, *chat_user);
+
+    return;
+  }
+
+  // Notify other clients
+  TypedBuffer clients_buffer = server_->CreateBuffer();
+  clients_buffer.WriteUInt16(kChannelMessageResult_UserKicked);
+  clients_buffer.WriteString(channel->Name);
+  clients_buffer.WriteString(kick_user->Username);
+  clients_buffer.WriteString(kick_user->Hostname);
+
+  broadcast(*channel, handle, kChannelMessageType_KickUser, clients_buffer,
+    kSendPriority_Control);
+
+  // Tell the client that the user was kicked
+  TypedBuffer send_buffer = server_->CreateBuffer();
+  send_buffer.WriteUInt16(kChannelMessageResult_Ok);
+  send_buffer.WriteString(channel->Name);
+  send_buffer.WriteString(target);
+  send_buffer.WriteString(kick_user->Username);
+  send_buffer.WriteString(kick_user->Hostname);
+  server_->Send(handle, kComponentType_Channel,
+    kChannelMessageType_KickUser_Complete, send_buffer);
+
+  // Remove the client from channel client lists
+  eraseChannelClient(channel, kick_user_key);
+  publishRecipients(*channel);
+
+  // Trigger events
+  OnKickUserCompleted(kChannelMessageResult_Ok, channel->Name, target,
+    *chat_user);
+  OnChannelUserKicked(*channel, *kick_user);
+}
+
+void ChannelComponent::banChannelUser(std::shared_ptr<ChatChannel> channel,
+  ConnectionHandle handle, std::shared_ptr<ChatUser> chat_user,
+  std::string target) {
+  // Check if the channel still exists
+  if (!channel->Enabled) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_InvalidChannelName);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_BanUser_Complete, send_buffer);
+
+    // Trigger events
+    OnBanUserCompleted(kChannelMessageResult_InvalidChannelName,
+      channel->Name, target, *chat_user);
+
+    return;
+  }
+
+  // Check if the user is in the channel
+  if (!channel->Clients.Contains(handle)) {
+    // Notify the client that they are not in the channel
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_NotInChannel);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_BanUser_Complete, send_buffer);
+
+    // Trigger events
+    OnBanUserCompleted(kChannelMessageResult_NotInChannel, channel->Name,
+      target, *chat_user);
+
+    return;
+  }
+
+  // Check if the user has permissions
+  if (!channel->Operators.Contains(handle)) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_NotPermitted);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_BanUser_Complete, send_buffer);
+
+    // Trigger events
+    OnBanUserCompleted(kChannelMessageResult_NotPermitted, channel->Name,
+      target, *chat_user);
+
+    return;
+  }
+
+  // A target with @, * or ? is a mask rather than a member. It keeps whoever
+  // matches it from joining, but doesn't remove anyone already in the channel
+  if (String::Contains(target, "@") || BanList::IsWildcard(target)) {
+    std::string mask = target;
+    if (!String::Contains(mask, "@")) {
+      mask += "@*";
+    }
+
+    // Check if the user is trying to ban a mask which matches themself
+    if (BanList::IsMatch(mask, chat_user->Username, chat_user->Hostname)) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_CannotBanSelf);
+      send_buffer.WriteString(channel->Name);
+      send_buffer.WriteString(target);
+      server_->Send(handle, kComponentType_Channel,
+        kChannelMessageType_BanUser_Complete, send_buffer);
+
+      // Trigger events
+      OnBanUserCompleted(kChannelMessageResult_CannotBanSelf, channel->Name,
+        target, *chat_user);
+
+      return;
+    }
+
+    if (!channel->BannedUsers.Add(mask)) {
+      TypedBuffer send_buffer = server_->CreateBuffer();
+      send_buffer.WriteUInt16(kChannelMessageResult_AlreadyBanned);
+      send_buffer.WriteString(channel->Name);
+      send_buffer.WriteString(target);
+      server_->Send(handle, kComponentType_Channel,
+        kChannelMessageType_BanUser_Complete, send_buffer);
+
+      // Trigger events
+      OnBanUserCompleted(kChannelMessageResult_AlreadyBanned, channel->Name,
+        target, *chat_user);
+
+      return;
+    }
+
+    // Notify other clients. The mask is sent split at its @, in place of the
+    // username and hostname, under a result of its own since nobody is
+    // removed from the channel
+    size_t separator = mask.find('@');
+    std::string mask_username = mask.substr(0, separator);
+    std::string mask_hostname = mask.substr(separator + 1);
+    TypedBuffer clients_buffer = server_->CreateBuffer();
+    clients_buffer.WriteUInt16(kChannelMessageResult_MaskBanned);
+    clients_buffer.WriteString(channel->Name);
+    clients_buffer.WriteString(mask_username);
+    clients_buffer.WriteString(mask_hostname);
+
+    broadcast(*channel, handle, kChannelMessageType_BanUser, clients_buffer,
+      kSendPriority_Control);
+
+    // Tell the client that the mask was banned
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_Ok);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    send_buffer.WriteString(mask_username);
+    send_buffer.WriteString(mask_hostname);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_BanUser_Complete, send_buffer);
+
+    // Trigger events
+    OnBanUserCompleted(kChannelMessageResult_Ok, channel->Name, target,
+      *chat_user);
+
+    return;
+  }
+
+  // Check if the user is trying to ban themself
+  std::string folded_target = String::ToLower(target);
+  if (folded_target == String::ToLower(chat_user->Username)) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_CannotBanSelf);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_BanUser_Complete, send_buffer);
+
+    // Trigger events
+    OnBanUserCompleted(kChannelMessageResult_CannotBanSelf, channel->Name,
+      target, *chat_user);
+
+    return;
+  }
+
+  // Check if the target is in the channel
+  ConnectionHandle ban_user_key;
+  std::shared_ptr<ChatUser> ban_user;
+  std::string target_string;
+  auto member = channel->Members.find(folded_target);
+  if (member != channel->Members.end()) {
+    ban_user_key = member->second.Handle;
+    ban_user = *channel->Clients.Find(ban_user_key);
+    target_string = ban_user->Username + "@" + ban_user->Hostname;
+  }
+  if (target_string.empty()) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_InvalidUsername);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_BanUser_Complete, send_buffer);
+
+    // Trigger events
+    OnBanUserCompleted(kChannelMessageResult_InvalidUsername, channel->Name,
+      target, *chat_user);
+
+    return;
+  }
+
+  // Ban the user, unless they already are
+  if (!channel->BannedUsers.Add(target_string)) {
+    TypedBuffer send_buffer = server_->CreateBuffer();
+    send_buffer.WriteUInt16(kChannelMessageResult_AlreadyBanned);
+    send_buffer.WriteString(channel->Name);
+    send_buffer.WriteString(target);
+    server_->Send(handle, kComponentType_Channel,
+      kChannelMessageType_BanUser_Complete, send_buffer);
+
+    // Trigger events
+    OnBanUserCompleted(kChannelMessageResult_AlreadyBanned, channel->Name,
+      target, *chat_user);
+
+    return;
+  }
+
+  // Notify other clients
+  TypedBuffer clients_buffer = server_->CreateBuffer();
+  clients_buffer.WriteUInt16(kChannelMessageResult_UserBanned);
+  clients_buffer.WriteString(channel->Name);
+  clients_buffer.WriteString(ban_user->Username);
+  clients_buffer.WriteString(ban_user->Hostname);
+
+  broadcast(*channel, handle, kChannelMessageType_BanUser, clients_buffer,
+    kSendPriority_Control);
+
+  // Tell the client that the user was banned
+  TypedBuffer send_buffer = server_->CreateBuffer();
+  send_buffer.WriteUInt16(kChannelMessageResult_Ok);
+  send_buffer.WriteString(channel->Name);
+  send_buffer.WriteString(target);
+  send_buffer.WriteString(ban_user->Username);
+  send_buffer.WriteString(ban_user->Hostname);
+  server_->Send(handle, kComponentType_Channel,
+    kChannelMessageType_BanUser_Complete, send_buffer);
+
+  // Remove the client from channel client lists
+  eraseChannelClient(channel, ban_user_key);
+  publishRecipients(*channel);
+
+  // Trigger events
+  OnBanUserCompleted(kChannelMessageResult_Ok, channel->Name, target,
+    *chat_user);
+  OnChannelUserBanned(*channel, *ban_user);
+}
+
+void ChannelComponent::removeChannelClient(
+  std::shared_ptr<ChatChannel> channel, ConnectionHandle handle) {
+  if (!channel->Enabled) {
+    return;
+  }
+
+  std::shared_ptr<ChatUser> *client = channel->Clients.Find(handle);
+  if (client == nullptr) {
+    return;
+  }
+
+  // Get the chat user
+  std::shared_ptr<ChatUser> chat_user = *client;
+
+  // Notify all clients in that channel that the client left
+  TypedBuffer clients_buffer = server_->CreateBuffer();
+  clients_buffer.WriteUInt16(kChannelMessageResult_UserLeft);
+  clients_buffer.WriteString(channel->Name);
+  clients_buffer.WriteString(chat_user->Username);
+  clients_buffer.WriteString(chat_user->Hostname);
+
+  broadcast(*channel, handle, kChannelMessageType_LeaveChannel, clients_buffer,
+    kSendPriority_Control);
+
+  // Trigger the events
+  OnChannelLeft(*channel, *chat_user);
+
+  // Remove the client from the clients and operators lists
+  eraseChannelClient(channel, handle);
+  publishRecipients(*channel);
+
+  // If there was nobody in the channel delete it
+  if (channel->Clients.IsEmpty()) {
+    disableChannel(*channel);
+  }
+}
+}
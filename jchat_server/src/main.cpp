@@ -1,70 +1,167 @@
-/*
-*   This file is part of the jChatSystem project.
-*
-*   This program is licensed under the GNU General
-*   Public License. To view the full license, check
-*   LICENSE in the project root.
-*/
-
-// Required libraries
-#include "command_line.hpp"
-#include "chat_server.h"
-#include "components/system_component.h"
-#include "components/user_component.h"
-#include "components/channel_component.h"
-#include <iostream>
-#include <chrono>
-#include <thread>
-
-// Program entrypoint
-int main(int argc, char **argv) {
-  std::cout << "jChatSystem - Server" << std::endl;
-
-  jchat::CommandLine command_line(argc, argv);
-  if (argc > 1) {
-	  std::cout << "Starting with arguments..." << std::endl;
-	  std::cout << command_line << std::endl;
-  }
-
-  jchat::ChatServer chat_server(
-    command_line.GetString("ipaddress", "0.0.0.0").c_str(),
-    command_line.GetInt32("port", 9998));
-
-  auto system_component = std::make_shared<jchat::SystemComponent>();
-  auto user_component = std::make_shared<jchat::UserComponent>();
-  auto channel_component = std::make_shared<jchat::ChannelComponent>();
-
-  chat_server.AddComponent(system_component);
-  chat_server.AddComponent(user_component);
-  chat_server.AddComponent(channel_component);
-
-  chat_server.OnClientConnected.Add([](jchat::RemoteChatClient &client) {
-    std::cout << "Client from "
-              << client.Endpoint.ToString()
-              << " connected"
-              << std::endl;
-    return true;
-  });
-  chat_server.OnClientDisconnected.Add([](jchat::RemoteChatClient &client) {
-    std::cout << "Client from "
-              << client.Endpoint.ToString()
-              << " disconnected"
-              << std::endl;
-    return true;
-  });
-  if (chat_server.Start()) {
-    std::cout << "Started listening on "
-              << chat_server.GetListenEndpoint().ToString()
-              << std::endl;
-    while (true) {
-      std::this_thread::sleep_for(std::chrono::seconds(1));
-    }
-  } else {
-    std::cout << "Failed to listen on "
-              << chat_server.GetListenEndpoint().ToString()
-              << std::endl;
-    return -1;
-  }
-
-  return 0;
-}
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+// Required libraries
+#include "command_line.hpp"
+#include "chat_server.h"
+#include "components/system_component.h"
+#include "components/user_component.h"
+#include "components/channel_component.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// Reads the -<name>_rate (messages per second) and -<name>_byte_rate (bytes
+// per second) arguments. Bursts are twice the rate, and the byte burst always
+// fits a message of the largest size, otherwise those could never be sent
+jchat::TrafficLimit getTrafficLimit(jchat::CommandLine &command_line,
+  const std::string &name) {
+  jchat::TrafficLimit limit;
+  limit.Messages.Rate = command_line.GetInt32(name + "_rate", 0);
+  limit.Messages.Burst = limit.Messages.Rate * 2;
+  limit.Bytes.Rate = command_line.GetInt32(name + "_byte_rate", 0);
+  limit.Bytes.Burst = std::max<uint32_t>(limit.Bytes.Rate * 2,
+    JCHAT_CHAT_MESSAGE_LENGTH);
+  return limit;
+}
+
+// Loads the deny list if its file changed
+void refreshDenyList(jchat::IpFilter &ip_filter) {
+  bool is_loaded = false;
+  size_t count = 0;
+  if (!ip_filter.Refresh(is_loaded, count)) {
+    return;
+  }
+  if (is_loaded) {
+    std::cout << "Loaded " << count << " denied address ranges" << std::endl;
+  } else {
+    std::cout << "Failed to load the deny list, keeping the old one"
+              << std::endl;
+  }
+}
+
+// Program entrypoint
+int main(int argc, char **argv) {
+  std::cout << "jChatSystem - Server" << std::endl;
+
+  jchat::CommandLine command_line(argc, argv);
+  if (argc > 1) {
+	  std::cout << "Starting with arguments..." << std::endl;
+	  std::cout << command_line << std::endl;
+  }
+
+  jchat::ChatServer chat_server(
+    command_line.GetString("ipaddress", "0.0.0.0").c_str(),
+    command_line.GetInt32("port", 9998),
+    command_line.GetInt32("threads", 1));
+
+  // Transport options
+  jchat::TcpServer &tcp_server = chat_server.GetTcpServer();
+  tcp_server.SetUseIoUring(command_line.FlagExists("io_uring"));
+  tcp_server.SetBacklog(command_line.GetInt32("backlog",
+    JCHAT_TCP_SERVER_BACKLOG));
+  tcp_server.SetDeferAccept(command_line.GetInt32("defer_accept", 0));
+  tcp_server.SetFastOpen(command_line.GetInt32("fastopen", 0));
+  tcp_server.SetSharded(command_line.FlagExists("sharded"));
+  tcp_server.SetCoalesceBudget(command_line.GetInt32("coalesce", 0));
+  tcp_server.SetReadBudget(command_line.GetInt32("read_budget",
+    JCHAT_TCP_SERVER_READ_BUDGET), command_line.GetInt32("frame_budget",
+    JCHAT_TCP_SERVER_FRAME_BUDGET));
+
+  // Slow consumers, see TcpServer::SetSlowConsumerPolicy
+  tcp_server.SetSendWatermarks(command_line.GetInt32("send_low",
+    JCHAT_TCP_SERVER_SEND_LOW_WATERMARK), command_line.GetInt32("send_high",
+    JCHAT_TCP_SERVER_SEND_HIGH_WATERMARK));
+  std::string slow_policy = command_line.GetString("slow_policy", "drop");
+  if (slow_policy == "disconnect") {
+    tcp_server.SetSlowConsumerPolicy(jchat::kSlowConsumerPolicy_Disconnect);
+  } else if (slow_policy == "stop") {
+    tcp_server.SetSlowConsumerPolicy(jchat::kSlowConsumerPolicy_StopFanout);
+  }
+
+  // Addresses and ranges to turn away, reloaded whenever the file changes
+  jchat::IpFilter &ip_filter = tcp_server.GetIpFilter();
+  ip_filter.SetFile(command_line.GetString("deny_file", ""));
+  refreshDenyList(ip_filter);
+
+  // Run the components on a pool of workers instead of the reactor threads
+  chat_server.SetWorkerCount(command_line.GetInt32("workers", 0));
+
+  // Chat message rate limits, per second with twice that as the burst. They
+  // are all off by default
+  jchat::RateLimiter &rate_limiter = chat_server.GetRateLimiter();
+  rate_limiter.SetClientLimit(getTrafficLimit(command_line, "client"));
+  rate_limiter.SetAddressLimit(getTrafficLimit(command_line, "address"));
+  rate_limiter.SetChannelLimit(getTrafficLimit(command_line, "channel"));
+
+  auto system_component = std::make_shared<jchat::SystemComponent>();
+  auto user_component = std::make_shared<jchat::UserComponent>();
+  auto channel_component = std::make_shared<jchat::ChannelComponent>();
+
+  chat_server.AddComponent(system_component);
+  chat_server.AddComponent(user_component);
+  chat_server.AddComponent(channel_component);
+
+  chat_server.OnClientConnected.Add([](jchat::RemoteChatClient &client) {
+    std::cout << "Client from "
+              << client.Endpoint.ToString()
+              << " connected"
+              << std::endl;
+    return true;
+  });
+  chat_server.OnClientDisconnected.Add([](jchat::RemoteChatClient &client) {
+    std::cout << "Client from "
+              << client.Endpoint.ToString()
+              << " disconnected"
+              << std::endl;
+    return true;
+  });
+  if (chat_server.Start()) {
+    std::cout << "Started listening on "
+              << chat_server.GetListenEndpoint().ToString()
+              << (tcp_server.IsUsingIoUring()
+                ? " using io_uring" : "")
+              << std::endl;
+    uint64_t slow_consumer_total = 0;
+    uint64_t denied_total = 0;
+    while (true) {
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+      refreshDenyList(ip_filter);
+
+      // Report connections turned away by the deny list
+      uint64_t denied = tcp_server.GetDeniedConnections();
+      if (denied != denied_total) {
+        denied_total = denied;
+        std::cout << "Denied connections: " << denied << std::endl;
+      }
+
+      // Report slow consumers whenever the policy had to step in
+      jchat::SlowConsumerCounters counters =
+        tcp_server.GetSlowConsumerCounters();
+      uint64_t total = counters.DroppedFrames + counters.RefusedFrames
+        + counters.FanoutStops + counters.Disconnects;
+      if (total != slow_consumer_total) {
+        slow_consumer_total = total;
+        std::cout << "Slow consumers: "
+                  << counters.DroppedFrames << " dropped, "
+                  << counters.RefusedFrames << " refused, "
+                  << counters.FanoutStops << " fan-out stops, "
+                  << counters.Disconnects << " disconnects"
+                  << std::endl;
+      }
+    }
+  } else {
+    std::cout << "Failed to listen on "
+              << chat_server.GetListenEndpoint().ToString()
+              << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*
+*   This file is part of the jChatSystem project.
+*
+*   This program is licensed under the GNU General
+*   Public License. To view the full license, check
+*   LICENSE in the project root.
+*/
+
+#include "rate_limiter.h"
+
+namespace jchat {
+RateLimiter::RateLimiter() : client_limit_(), address_limit_(),
+  channel_limit_() {
+}
+
+RateLimiter::AddressShard &RateLimiter::getAddressShard(uint32_t address) {
+  // Mix the bits so that neighbouring addresses land on different shards
+  uint32_t hash = address * 2654435761u;
+  return address_shards_[(hash >> 16) & (JCHAT_RATE_LIMITER_SHARDS - 1)];
+}
+
+void RateLimiter::SetClientLimit(const TrafficLimit &limit) {
+  client_limit_ = limit;
+}
+
+void RateLimiter::SetAddressLimit(const TrafficLimit &limit) {
+  address_limit_ = limit;
+}
+
+void RateLimiter::SetChannelLimit(const TrafficLimit &limit) {
+  channel_limit_ = limit;
+}
+
+TrafficLimit RateLimiter::GetClientLimit() {
+  return client_limit_;
+}
+
+TrafficLimit RateLimiter::GetAddressLimit() {
+  return address_limit_;
+}
+
+TrafficLimit RateLimiter::GetChannelLimit() {
+  return channel_limit_;
+}
+
+void RateLimiter::AddClient(RemoteChatClient &client) {
+  uint32_t address = client.Endpoint.GetAddress();
+  AddressShard &shard = getAddressShard(address);
+  std::lock_guard<std::mutex> shard_lock(shard.Mutex);
+  shard.Entries[address].ClientCount++;
+}
+
+void RateLimiter::RemoveClient(RemoteChatClient &client) {
+  uint32_t address = client.Endpoint.GetAddress();
+  AddressShard &shard = getAddressShard(address);
+  std::lock_guard<std::mutex> shard_lock(shard.Mutex);
+  auto it = shard.Entries.find(address);
+  if (it != shard.Entries.end() && --it->second.ClientCount == 0) {
+    shard.Entries.erase(it);
+  }
+}
+
+bool RateLimiter::TakeClient(RemoteChatClient &client, size_t size) {
+  uint64_t now = TokenBucket::Now();
+  if (!client.Traffic.Messages.CanTake(client_limit_.Messages, 1, now)
+    || !client.Traffic.Bytes.CanTake(client_limit_.Bytes, size, now)) {
+    return false;
+  }
+
+  // Only take from the client once the address has room too, so that a
+  // refused message doesn't count against the client
+  if (address_limit_.Messages.Rate != 0 || address_limit_.Bytes.Rate != 0) {
+    uint32_t address = client.Endpoint.GetAddress();
+    AddressShard &shard = getAddressShard(address);
+    std::lock_guard<std::mutex> shard_lock(shard.Mutex);
+    auto it = shard.Entries.find(address);
+    if (it != shard.Entries.end()
+      && !it->second.Bucket.Take(address_limit_, size, now)) {
+      return false;
+    }
+  }
+
+  return client.Traffic.Take(client_limit_, size, now);
+}
+
+bool RateLimiter::TakeChannel(ChatChannel &channel, size_t size) {
+  return channel.Traffic.Take(channel_limit_, size, TokenBucket::Now());
+}
+}